@@ -0,0 +1,252 @@
+#include "bench_util.h"
+#include "body.h"
+#include "collision.h"
+#include "forces.h"
+#include "list.h"
+#include "polygon.h"
+#include "random.h"
+#include "scene.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Microbenchmarks for the core library. Prints one line of JSON per
+// benchmark (see bench_run()), e.g. for tools/perf_gate.py to compare.
+// The scenes are ticked with a tiny dt so they barely change while they are
+// measured, and every sample does the same work.
+
+const size_t VERTEX_COUNTS[] = {4, 16, 64};
+const size_t VERTEX_COUNT_COUNT = 3;
+const double SHAPE_RADIUS = 10;
+const size_t LIST_LENGTH = 64;
+const double BENCH_DT = 1e-6;
+const unsigned int BENCH_SEED = 1234;
+const rgb_color_t BENCH_COLOR = {0.5, 0.5, 0.5};
+
+// scenes with one kind of force between FORCE_BODIES bodies on a grid
+const size_t FORCE_BODIES = 64;
+const size_t FORCE_GRID_WIDTH = 8;
+const double FORCE_SPACING = 15;
+const double FORCE_BODY_SIZE = 10;
+
+// scenes like the nbodies demo: gravity and collisions between every pair
+const size_t NBODIES_COUNTS[] = {8, 32, 128};
+const size_t NBODIES_COUNT_COUNT = 3;
+const double NBODIES_SPREAD = 400;
+const double NBODIES_G = 100;
+
+typedef struct collision_bench {
+  list_t *shape1;
+  list_t *shape2;
+} collision_bench_t;
+
+void bench_find_collision(void *state, size_t iterations) {
+  collision_bench_t *shapes = state;
+  for (size_t i = 0; i < iterations; i++) {
+    bench_use(find_collision(shapes->shape1, shapes->shape2).axis.x);
+  }
+}
+
+void bench_polygon_centroid(void *polygon, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    bench_use(polygon_centroid(polygon).x);
+  }
+}
+
+void bench_polygon_rotate(void *polygon, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    polygon_rotate(polygon, 0.01, VEC_ZERO);
+  }
+}
+
+void run_shape_benches(void) {
+  char name[100];
+  for (size_t i = 0; i < VERTEX_COUNT_COUNT; i++) {
+    size_t n = VERTEX_COUNTS[i];
+    collision_bench_t shapes = {make_closed_polygon(SHAPE_RADIUS, n),
+                                make_closed_polygon(SHAPE_RADIUS, n)};
+    polygon_translate(shapes.shape2, (vector_t){SHAPE_RADIUS, 0});
+    snprintf(name, sizeof(name), "find_collision/%zu/overlap", n);
+    bench_run(name, bench_find_collision, &shapes);
+    polygon_translate(shapes.shape2, (vector_t){2 * SHAPE_RADIUS, 0});
+    snprintf(name, sizeof(name), "find_collision/%zu/apart", n);
+    bench_run(name, bench_find_collision, &shapes);
+
+    snprintf(name, sizeof(name), "polygon_centroid/%zu", n);
+    bench_run(name, bench_polygon_centroid, shapes.shape1);
+    snprintf(name, sizeof(name), "polygon_rotate/%zu", n);
+    bench_run(name, bench_polygon_rotate, shapes.shape1);
+    list_free(shapes.shape1);
+    list_free(shapes.shape2);
+  }
+}
+
+void bench_list_add_remove_back(void *list, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    list_add(list, list);
+    list_remove(list, list_size(list) - 1);
+  }
+}
+
+void bench_list_add_remove_front(void *list, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    list_add(list, list);
+    list_remove(list, 0);
+  }
+}
+
+void run_list_benches(void) {
+  list_t *list = list_init(LIST_LENGTH + 1, NULL);
+  for (size_t i = 0; i < LIST_LENGTH; i++) {
+    list_add(list, list);
+  }
+  bench_run("list/add_remove_back/64", bench_list_add_remove_back, list);
+  bench_run("list/add_remove_front/64", bench_list_add_remove_front, list);
+  list_free(list);
+}
+
+void bench_body_tick(void *body, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    body_add_force(body, (vector_t){1, 1});
+    body_tick(body, BENCH_DT);
+  }
+}
+
+void run_body_benches(void) {
+  body_t *body =
+      body_init(make_closed_polygon(SHAPE_RADIUS, 16), 1, BENCH_COLOR);
+  body_set_velocity(body, (vector_t){1, 2});
+  body_set_angular_velocity(body, 0.5);
+  bench_run("body_tick", bench_body_tick, body);
+  body_free(body);
+}
+
+void bench_scene_tick(void *scene, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    scene_tick(scene, BENCH_DT);
+  }
+}
+
+/** Makes a list of the given bodies, for a force creator */
+list_t *bench_bodies(body_t *first, body_t *second) {
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, first);
+  if (second != NULL) {
+    list_add(bodies, second);
+  }
+  return bodies;
+}
+
+typedef enum {
+  FORCE_NONE,
+  FORCE_EARTH_GRAVITY,
+  FORCE_NEWTONIAN_GRAVITY,
+  FORCE_SPRING,
+  FORCE_SPRING_NETWORK,
+  FORCE_DRAG,
+  FORCE_PHYSICS_COLLISION,
+  FORCE_DESTRUCTIVE_COLLISION,
+  FORCE_KINDS
+} bench_force_t;
+
+const char *const BENCH_FORCE_NAMES[] = {"none",
+                                         "earth_gravity",
+                                         "newtonian_gravity",
+                                         "spring",
+                                         "spring_network",
+                                         "drag",
+                                         "physics_collision",
+                                         "destructive_collision"};
+
+/**
+ * Makes a grid of bodies with one kind of force on each body, or between
+ * each body and its right-hand neighbor
+ */
+scene_t *force_scene_init(bench_force_t force) {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < FORCE_BODIES; i++) {
+    vector_t corner = {FORCE_SPACING * (i % FORCE_GRID_WIDTH),
+                       FORCE_SPACING * (i / FORCE_GRID_WIDTH)};
+    vector_t size = {FORCE_BODY_SIZE, FORCE_BODY_SIZE};
+    list_t *shape = make_rectangle(corner, vec_add(corner, size));
+    scene_add_body(scene, body_init(shape, 1, BENCH_COLOR));
+  }
+  spring_network_t *network = force == FORCE_SPRING_NETWORK
+                                  ? create_spring_network(scene, 1)
+                                  : NULL;
+  for (size_t i = 0; i < FORCE_BODIES; i++) {
+    body_t *body = scene_get_body(scene, i);
+    body_t *next = scene_get_body(scene, (i + 1) % FORCE_BODIES);
+    switch (force) {
+    case FORCE_EARTH_GRAVITY:
+      create_earth_gravity(scene, 9.8, bench_bodies(body, NULL));
+      break;
+    case FORCE_NEWTONIAN_GRAVITY:
+      create_newtonian_gravity(scene, NBODIES_G, bench_bodies(body, next));
+      break;
+    case FORCE_SPRING:
+      create_spring(scene, 1, bench_bodies(body, next));
+      break;
+    case FORCE_SPRING_NETWORK:
+      spring_network_add(network, 1, bench_bodies(body, next));
+      break;
+    case FORCE_DRAG:
+      create_drag(scene, 0.1, bench_bodies(body, NULL));
+      break;
+    case FORCE_PHYSICS_COLLISION:
+      create_physics_collision(scene, 0.9, bench_bodies(body, next));
+      break;
+    case FORCE_DESTRUCTIVE_COLLISION:
+      // the bodies never touch, or they would be removed
+      create_destructive_collision(scene, bench_bodies(body, next));
+      break;
+    default:
+      break;
+    }
+  }
+  return scene;
+}
+
+scene_t *nbodies_scene_init(size_t count) {
+  r_seed(BENCH_SEED);
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < count; i++) {
+    vector_t center = {r_double(0, NBODIES_SPREAD),
+                       r_double(0, NBODIES_SPREAD)};
+    scene_add_body(scene, body_init(make_star(5, 5, 10, center, 0), 10,
+                                    r_pastel_color()));
+  }
+  for (size_t i = 0; i < count; i++) {
+    for (size_t j = i + 1; j < count; j++) {
+      body_t *body = scene_get_body(scene, i);
+      body_t *other = scene_get_body(scene, j);
+      create_newtonian_gravity(scene, NBODIES_G, bench_bodies(body, other));
+      create_physics_collision(scene, 0.9, bench_bodies(body, other));
+    }
+  }
+  return scene;
+}
+
+void run_scene_benches(void) {
+  char name[100];
+  for (bench_force_t force = 0; force < FORCE_KINDS; force++) {
+    scene_t *scene = force_scene_init(force);
+    snprintf(name, sizeof(name), "scene_tick/%s/%zu", BENCH_FORCE_NAMES[force],
+             FORCE_BODIES);
+    bench_run(name, bench_scene_tick, scene);
+    scene_free(scene);
+  }
+  for (size_t i = 0; i < NBODIES_COUNT_COUNT; i++) {
+    scene_t *scene = nbodies_scene_init(NBODIES_COUNTS[i]);
+    snprintf(name, sizeof(name), "scene_tick/nbodies/%zu", NBODIES_COUNTS[i]);
+    bench_run(name, bench_scene_tick, scene);
+    scene_free(scene);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  run_shape_benches();
+  run_list_benches();
+  run_body_benches();
+  run_scene_benches();
+  return 0;
+}
@@ -0,0 +1,202 @@
+#include "alloc.h"
+#include "bench_util.h"
+#include "body.h"
+#include "forces.h"
+#include "polygon.h"
+#include "random.h"
+#include "scene.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Headless versions of the nbodies and gravity demos, used to compare the
+// energy drift and cost of each integrator.
+// For each (demo, integrator, dt), prints a line with the relative energy
+// drift after BENCH_SECONDS of simulated time and the engine allocations per
+// scene_tick, then one line of JSON timing a tick (see bench_run()).
+// tools/perf_gate.py only reads the JSON lines.
+
+const double BENCH_SECONDS = 5;
+const double BASE_DT = 1.0 / 60;
+const double DT_SCALES[] = {1, 4};
+const size_t DT_SCALE_COUNT = 2;
+const unsigned int BENCH_SEED = 1234;
+
+// nbodies.c
+const vector_t NBODIES_WINDOW = {1000, 500};
+const size_t NBODIES_COUNT = 100;
+const vector_t NBODIES_SPAWN_RANGE = {0.1, 0.9};
+const vector_t NBODIES_POINT_RANGE = {5, 8};
+const vector_t NBODIES_INNER_RADIUS_RANGE = {5, 20};
+const vector_t NBODIES_OUTER_TO_INNER_RANGE = {1.4, 2.0};
+const double NBODIES_MASS_TO_OUTER_RADIUS = 10;
+const double NBODIES_G = 500;
+// matches the cutoff in apply_newtonian_gravity()
+const double NBODIES_BLOW_UP_DISTANCE = 5;
+
+// gravity.c
+const size_t GRAVITY_STARS = 20;
+const double GRAVITY_INNER_RADIUS = 15;
+const double GRAVITY_OUTER_RADIUS = 30;
+const double GRAVITY_HEIGHT = 500;
+const double GRAVITY_MASS = 50;
+const double GRAVITY_G = 1000;
+const double GRAVITY_VELOCITY_X = 100;
+
+const char *INTEGRATOR_NAMES[] = {"average_velocity", "semi_implicit_euler",
+                                  "velocity_verlet", "rk4"};
+const size_t INTEGRATOR_COUNT = 4;
+
+typedef struct bench_demo {
+  const char *name;
+  scene_t *(*init)(void);
+  void (*step)(scene_t *scene);
+  double (*energy)(scene_t *scene);
+} bench_demo_t;
+
+double kinetic_energy(body_t *body) {
+  vector_t velocity = body_get_velocity(body);
+  return 0.5 * body_get_mass(body) * vec_dot(velocity, velocity);
+}
+
+scene_t *nbodies_init(void) {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < NBODIES_COUNT; i++) {
+    int points = r_int(NBODIES_POINT_RANGE.x, NBODIES_POINT_RANGE.y);
+    double inner = r_double(NBODIES_INNER_RADIUS_RANGE.x,
+                            NBODIES_INNER_RADIUS_RANGE.y);
+    double outer = inner * r_double(NBODIES_OUTER_TO_INNER_RANGE.x,
+                                    NBODIES_OUTER_TO_INNER_RANGE.y);
+    vector_t center = {
+        r_double(NBODIES_SPAWN_RANGE.x, NBODIES_SPAWN_RANGE.y) *
+            NBODIES_WINDOW.x,
+        r_double(NBODIES_SPAWN_RANGE.x, NBODIES_SPAWN_RANGE.y) *
+            NBODIES_WINDOW.y};
+    scene_add_body(scene,
+                   body_init(make_star(points, inner, outer, center, 0),
+                             outer * NBODIES_MASS_TO_OUTER_RADIUS,
+                             r_pastel_color()));
+  }
+  for (size_t i = 0; i < scene_bodies(scene) - 1; i++) {
+    for (size_t j = i + 1; j < scene_bodies(scene); j++) {
+      list_t *bodies = list_init(2, NULL);
+      list_add(bodies, scene_get_body(scene, i));
+      list_add(bodies, scene_get_body(scene, j));
+      create_newtonian_gravity(scene, NBODIES_G, bodies);
+    }
+  }
+  return scene;
+}
+
+void nbodies_step(scene_t *scene) {}
+
+double nbodies_energy(scene_t *scene) {
+  double energy = 0;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    energy += kinetic_energy(body);
+    for (size_t j = i + 1; j < scene_bodies(scene); j++) {
+      body_t *other = scene_get_body(scene, j);
+      double distance = fmax(
+          sqrt(vec_dot(vec_subtract(body_get_centroid(body),
+                                    body_get_centroid(other)),
+                       vec_subtract(body_get_centroid(body),
+                                    body_get_centroid(other)))),
+          NBODIES_BLOW_UP_DISTANCE);
+      energy -= NBODIES_G * body_get_mass(body) * body_get_mass(other) /
+                distance;
+    }
+  }
+  return energy;
+}
+
+scene_t *gravity_init(void) {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < GRAVITY_STARS; i++) {
+    vector_t start = {GRAVITY_OUTER_RADIUS,
+                      GRAVITY_HEIGHT * (i + 1) / GRAVITY_STARS};
+    body_t *star = body_init(make_star(3 + i % 5, GRAVITY_INNER_RADIUS,
+                                       GRAVITY_OUTER_RADIUS, start, 0),
+                             GRAVITY_MASS, r_color());
+    body_set_velocity(star, (vector_t){GRAVITY_VELOCITY_X, 0});
+    scene_add_body(scene, star);
+    list_t *bodies = list_init(1, NULL);
+    list_add(bodies, star);
+    create_earth_gravity(scene, GRAVITY_G, bodies);
+  }
+  return scene;
+}
+
+// perfectly elastic version of check_collisions() in gravity.c, done on
+// centroids so the bounce itself does not change the energy
+void gravity_step(scene_t *scene) {
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    vector_t velocity = body_get_velocity(body);
+    if (body_get_centroid(body).y <= 0 && velocity.y < 0) {
+      body_set_velocity(body, (vector_t){velocity.x, -velocity.y});
+    }
+  }
+}
+
+double gravity_energy(scene_t *scene) {
+  double energy = 0;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    energy += kinetic_energy(body) +
+              body_get_mass(body) * GRAVITY_G * body_get_centroid(body).y;
+  }
+  return energy;
+}
+
+typedef struct integrator_bench {
+  bench_demo_t *demo;
+  scene_t *scene;
+  double dt;
+} integrator_bench_t;
+
+void bench_demo_tick(void *state, size_t iterations) {
+  integrator_bench_t *bench = state;
+  for (size_t i = 0; i < iterations; i++) {
+    bench->demo->step(bench->scene);
+    scene_tick(bench->scene, bench->dt);
+  }
+}
+
+void run(bench_demo_t *demo, integrator_t integrator, double dt_scale) {
+  char name[100];
+  snprintf(name, sizeof(name), "integrator/%s/%s/dt%gx", demo->name,
+           INTEGRATOR_NAMES[integrator], dt_scale);
+  if (!bench_selected(name)) {
+    return;
+  }
+  r_seed(BENCH_SEED);
+  integrator_bench_t bench = {demo, demo->init(), BASE_DT * dt_scale};
+  scene_set_integrator(bench.scene, integrator);
+  double start_energy = demo->energy(bench.scene);
+  size_t ticks = (size_t)(BENCH_SECONDS / bench.dt);
+  alloc_reset_stats();
+  bench_demo_tick(&bench, ticks);
+  double drift =
+      fabs((demo->energy(bench.scene) - start_energy) / start_energy);
+  double allocations = (double)alloc_total_stats().allocations / ticks;
+
+  printf("%s: energy drift %.3e, %.3f allocs/tick\n", name, drift,
+         allocations);
+  bench_run(name, bench_demo_tick, &bench);
+  scene_free(bench.scene);
+}
+
+int main(int argc, char *argv[]) {
+  bench_demo_t demos[] = {
+      {"nbodies", nbodies_init, nbodies_step, nbodies_energy},
+      {"gravity", gravity_init, gravity_step, gravity_energy}};
+  for (size_t d = 0; d < sizeof(demos) / sizeof(bench_demo_t); d++) {
+    for (size_t s = 0; s < DT_SCALE_COUNT; s++) {
+      for (size_t i = 0; i < INTEGRATOR_COUNT; i++) {
+        run(&demos[d], (integrator_t)i, DT_SCALES[s]);
+      }
+    }
+  }
+  return 0;
+}
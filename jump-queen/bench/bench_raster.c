@@ -0,0 +1,121 @@
+#include "bench_util.h"
+#include "polygon.h"
+#include "random.h"
+#include "raster.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Measures the software rasterizer on frames like the demos draw, without
+// a display. Prints one line of JSON (see bench_run()) per scene for
+// clearing a frame and for filling all of its polygons.
+
+const unsigned int BENCH_SEED = 1234;
+const size_t FRAME_WIDTH = 800, FRAME_HEIGHT = 600;
+const uint32_t BACKGROUND = 0xffffffff;
+
+// Jump Queen: a full-screen background and large axis-aligned platforms
+const size_t PLATFORM_COUNT = 40;
+const vector_t PLATFORM_SIZE_RANGE = {40, 200};
+
+// nbodies.c: many small stars
+const size_t STAR_COUNT = 100;
+const vector_t STAR_POINT_RANGE = {5, 8};
+const vector_t STAR_INNER_RADIUS_RANGE = {5, 20};
+const double STAR_OUTER_TO_INNER = 1.7;
+
+typedef struct bench_polygon {
+  vector_t *points;
+  size_t n;
+  uint32_t color;
+} bench_polygon_t;
+
+uint32_t random_color(void) {
+  rgb_color_t color = r_color();
+  return 0xff000000 | (uint32_t)(color.r * 255) << 16 |
+         (uint32_t)(color.g * 255) << 8 | (uint32_t)(color.b * 255);
+}
+
+/** Copies a polygon out of a list, which it frees */
+bench_polygon_t from_list(list_t *shape) {
+  bench_polygon_t polygon = {.n = list_size(shape), .color = random_color()};
+  polygon.points = malloc(polygon.n * sizeof(vector_t));
+  for (size_t i = 0; i < polygon.n; i++) {
+    polygon.points[i] = *(vector_t *)list_get(shape, i);
+  }
+  list_free(shape);
+  return polygon;
+}
+
+vector_t random_point(void) {
+  return (vector_t){r_double(0, FRAME_WIDTH), r_double(0, FRAME_HEIGHT)};
+}
+
+size_t platforms_init(bench_polygon_t *polygons) {
+  polygons[0] = from_list(make_rectangle(
+      VEC_ZERO, (vector_t){FRAME_WIDTH, FRAME_HEIGHT}));
+  for (size_t i = 1; i <= PLATFORM_COUNT; i++) {
+    vector_t corner = random_point();
+    vector_t size = {
+        r_double(PLATFORM_SIZE_RANGE.x, PLATFORM_SIZE_RANGE.y),
+        r_double(PLATFORM_SIZE_RANGE.x, PLATFORM_SIZE_RANGE.y) / 4};
+    polygons[i] = from_list(make_rectangle(corner, vec_add(corner, size)));
+  }
+  return PLATFORM_COUNT + 1;
+}
+
+size_t stars_init(bench_polygon_t *polygons) {
+  for (size_t i = 0; i < STAR_COUNT; i++) {
+    int points = r_int(STAR_POINT_RANGE.x, STAR_POINT_RANGE.y);
+    double inner =
+        r_double(STAR_INNER_RADIUS_RANGE.x, STAR_INNER_RADIUS_RANGE.y);
+    polygons[i] = from_list(make_star(points, inner, STAR_OUTER_TO_INNER * inner,
+                                      random_point(), 0));
+  }
+  return STAR_COUNT;
+}
+
+typedef struct raster_bench {
+  raster_t *raster;
+  bench_polygon_t *polygons;
+  size_t count;
+} raster_bench_t;
+
+void bench_raster_clear(void *state, size_t iterations) {
+  raster_bench_t *bench = state;
+  for (size_t i = 0; i < iterations; i++) {
+    raster_clear(bench->raster, BACKGROUND);
+  }
+}
+
+void bench_raster_fill(void *state, size_t iterations) {
+  raster_bench_t *bench = state;
+  for (size_t i = 0; i < iterations; i++) {
+    for (size_t j = 0; j < bench->count; j++) {
+      raster_fill_polygon(bench->raster, bench->polygons[j].points,
+                          bench->polygons[j].n, bench->polygons[j].color);
+    }
+  }
+}
+
+void run(const char *name, size_t (*init)(bench_polygon_t *polygons)) {
+  r_seed(BENCH_SEED);
+  bench_polygon_t polygons[PLATFORM_COUNT + STAR_COUNT + 1];
+  raster_bench_t bench = {raster_init(FRAME_WIDTH, FRAME_HEIGHT), polygons,
+                          init(polygons)};
+  char bench_name[100];
+  snprintf(bench_name, sizeof(bench_name), "raster/%s/clear", name);
+  bench_run(bench_name, bench_raster_clear, &bench);
+  snprintf(bench_name, sizeof(bench_name), "raster/%s/fill/%zu", name,
+           bench.count);
+  bench_run(bench_name, bench_raster_fill, &bench);
+  raster_free(bench.raster);
+  for (size_t i = 0; i < bench.count; i++) {
+    free(polygons[i].points);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  run("platforms", platforms_init);
+  run("stars", stars_init);
+  return 0;
+}
@@ -25,7 +25,7 @@ body_t *new_body_behavior(body_t *body) {
 }
 
 state_t *emscripten_init() {
-  srand(time(NULL));
+  r_seed(sdl_random_seed());
   state_t *cur_state = malloc(sizeof(state_t));
   cur_state->scene = scene_init();
 
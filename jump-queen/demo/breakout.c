@@ -329,7 +329,7 @@ void win(state_t *state) {
 }
 
 state_t *emscripten_init() {
-  srand(time(NULL));
+  r_seed(sdl_random_seed());
   sdl_init(VEC_ZERO, (vector_t){WINDOW_WIDTH, WINDOW_HEIGHT});
   state_t *state = malloc(sizeof(state_t));
   state->scene = scene_init();
@@ -8,6 +8,7 @@ const double PERIODS_ON_SCREEN = 3;
 const rgb_color_t BACKGROUND_COLOR = {1, 1, 1};
 const double STIFFNESS_K_CONSTANT = 300;
 const double DRAG_GAMMA_CONSTANT = 4;
+const size_t SPRING_SOLVER_ITERATIONS = 4;
 
 typedef struct state {
   scene_t *scene;
@@ -26,7 +27,7 @@ body_t *make_invisiball(vector_t center) {
 }
 
 state_t *emscripten_init() {
-  srand(time(NULL));
+  r_seed(sdl_random_seed());
   sdl_init(VEC_ZERO, (vector_t){WINDOW_WIDTH, WINDOW_HEIGHT});
   state_t *state = malloc(sizeof(state_t));
   state->scene = scene_init();
@@ -49,11 +50,14 @@ state_t *emscripten_init() {
     scene_add_body(state->scene, invisiball);
   }
   // adds all forces (spring & damping)
+  // springs are solved together implicitly so the tick length can vary freely
+  spring_network_t *springs =
+      create_spring_network(state->scene, SPRING_SOLVER_ITERATIONS);
   for (size_t i = 1; i < scene_bodies(state->scene); i += 2) {
     list_t *bodies = list_init(2, NULL);
     list_add(bodies, scene_get_body(state->scene, i));
     list_add(bodies, scene_get_body(state->scene, i + 1));
-    create_spring(state->scene, STIFFNESS_K_CONSTANT, bodies);
+    spring_network_add(springs, STIFFNESS_K_CONSTANT, bodies);
     bodies = list_init(1, NULL);
     list_add(bodies, scene_get_body(state->scene, i));
     create_drag(state->scene, DRAG_GAMMA_CONSTANT, bodies);
@@ -1,6 +1,5 @@
 #include "state.h"
 #include <assert.h>
-#include <time.h>
 
 const int STARTING_NUMBER_OF_SIDES = 3;
 const int STAR_TIME_INTERVAL = 2;
@@ -79,7 +78,7 @@ void check_collisions(scene_t *scene) {
 }
 
 state_t *emscripten_init() {
-  srand(time(NULL));
+  r_seed(sdl_random_seed());
   sdl_init(VEC_ZERO, vec_multiply(2, WINDOW_CENTER));
   state_t *state = malloc(sizeof(state_t));
   state->sides = STARTING_NUMBER_OF_SIDES;
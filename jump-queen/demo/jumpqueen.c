@@ -1,10 +1,14 @@
+#include "level.h"
 #include "state.h"
 #include <assert.h>
 #include <math.h>
 
 // ALL DISTANCE MEASUREMENTS ARE IN PROPORTION TO WINDOW WIDTH AND HEIGHT
-const size_t SCREEN_COUNT = 6;
+// written by tools/make_level.c; see "make level"
+const char *LEVEL_PATH = "levels/jumpqueen.lvl";
 const double LITTLE_G_CONSTANT = 2.5;
+const double SLEEP_VELOCITY = 1e-3;
+const double TIME_TO_SLEEP = 0.5; // in seconds
 
 const rgb_color_t WALL_COLOR = {1, 1, 1};
 const double WALL_THICKNESS = 50 / 2400.0;
@@ -47,13 +51,24 @@ typedef enum { LEFT, RIGHT, BOTTOM, TOP } direction_t;
 
 typedef enum { START = -1, PLAY = 0, WIN = 1, PAUSE = 2 } status_t;
 
+typedef struct screen {
+  bool loaded;
+  // handles to the screen's platforms while it is loaded
+  size_t platform_count;
+  body_handle_t *platforms;
+} screen_t;
+
 typedef struct state {
   status_t status;
   status_t last_status;
   int screen_num;
   scene_t *scene;
   body_t *background;
-  body_t *queen;
+  body_handle_t queen;
+  level_t *level;
+  // one per screen of the level; only the screens around the queen's
+  // are loaded into the scene at a time
+  screen_t *screens;
 } state_t;
 
 typedef enum {
@@ -83,7 +98,7 @@ typedef struct queen_traits {
   bool jump_released;
   double face_plant_timer;
 
-  body_t *movement_medium;
+  body_handle_t movement_medium;
 
   bool in_air;
   bool touching_bottom;
@@ -126,7 +141,7 @@ info_t *queen_info_init() {
   traits->jump_released = true;
   traits->face_plant_timer = 0;
 
-  traits->movement_medium = NULL;
+  traits->movement_medium = BODY_HANDLE_NULL;
 
   traits->in_air = false;
   traits->touching_bottom = false;
@@ -138,6 +153,26 @@ info_t *queen_info_init() {
   return info_init(QUEEN, traits);
 }
 
+body_t *get_queen(state_t *state) {
+  return scene_resolve(state->scene, state->queen);
+}
+
+// the platform the queen last stood on, or NULL if it is gone
+body_t *get_movement_medium(scene_t *scene, queen_traits_t *traits) {
+  return scene_resolve(scene, traits->movement_medium);
+}
+
+bool on_slippery_platform(scene_t *scene, queen_traits_t *traits) {
+  body_t *medium = get_movement_medium(scene, traits);
+  return medium != NULL &&
+         ((info_t *)body_get_info(medium))->type == SLIPPERY_PLATFORM;
+}
+
+vector_t get_medium_velocity(scene_t *scene, queen_traits_t *traits) {
+  body_t *medium = get_movement_medium(scene, traits);
+  return medium == NULL ? VEC_ZERO : body_get_velocity(medium);
+}
+
 void queen_zero_flags(body_t *queen) {
   queen_traits_t *traits = ((info_t *)body_get_info(queen))->traits;
   traits->touching_bottom = false;
@@ -147,14 +182,15 @@ void queen_zero_flags(body_t *queen) {
 
 void add_background(state_t *state) {
   list_t *bg_shape = make_rectangle(
-      VEC_ZERO, (vector_t){WINDOW_WIDTH, SCREEN_COUNT * WINDOW_HEIGHT});
+      VEC_ZERO,
+      (vector_t){WINDOW_WIDTH, level_screens(state->level) * WINDOW_HEIGHT});
   state->background = body_init_with_info(bg_shape, 0, BACKGROUND_COLOR,
                                           info_init(BACKGROUND, NULL), free);
   scene_add_body(state->scene, state->background);
 }
 
 double get_coordinate(body_t *body, direction_t side) {
-  list_t *shape = body_get_shape(body);
+  list_t *shape = body_get_real_shape(body);
   double out;
   switch (side) {
   case (LEFT):
@@ -170,7 +206,6 @@ double get_coordinate(body_t *body, direction_t side) {
     out = ((vector_t *)list_get(shape, 0))->y;
     break;
   }
-  list_free(shape);
   return out;
 }
 
@@ -200,10 +235,12 @@ void add_queen_hitbox(state_t *state) {
                           lowest_coordinate + 2};
   vector_t top_right = vec_add(bottom_left, vec_scale(QUEEN_DIM, WINDOW_DIM));
   info_t *info = queen_info_init();
-  state->queen =
+  body_t *queen =
       body_init_with_info(make_rectangle(bottom_left, top_right), QUEEN_MASS,
                           QUEEN_COLOR, info, (free_func_t)free_info);
-  scene_add_body(state->scene, state->queen);
+  // the queen is controlled by the player, so she must never fall asleep
+  body_set_sleepability(queen, false);
+  state->queen = scene_add_body(state->scene, queen);
 }
 
 void queen_toggle_crouch(body_t *queen, bool crouch) {
@@ -308,46 +345,68 @@ body_t *add_slippery_platform(scene_t *scene, vector_t bottom_left_corner,
   return slippery_platform;
 }
 
+void update_special_platform(state_t *state, body_t *platform, double dt) {
+  body_t *queen = get_queen(state);
+  queen_traits_t *queen_traits =
+      (queen_traits_t *)((info_t *)body_get_info(queen))->traits;
+  info_t *info = body_get_info(platform);
+  platform_traits_t *platform_traits = (platform_traits_t *)info->traits;
+  if (info->type == MOVING_X_PLATFORM || info->type == MOVING_Y_PLATFORM) {
+    int direction = -1 * platform_outside_boundaries(platform);
+    if (direction) {
+      vector_t platform_velocity = body_get_velocity(platform);
+      if (!queen_traits->in_air &&
+          get_movement_medium(state->scene, queen_traits) == platform) {
+        body_set_velocity(queen,
+                          vec_subtract(body_get_velocity(queen),
+                                       vec_multiply(2.0, platform_velocity)));
+      }
+      vector_t unsigned_velocity = {fabs(platform_velocity.x),
+                                    fabs(platform_velocity.y)};
+      body_set_velocity(platform, vec_multiply(direction, unsigned_velocity));
+    }
+  } else if (info->type == DISAPPEARING_PLATFORM) {
+    platform_traits->interval += dt;
+    if (platform_traits->interval > APPERANCE_INTERVAL) {
+      double translation = WINDOW_WIDTH;
+      if (body_get_centroid(platform).x > WINDOW_WIDTH) {
+        translation *= -1;
+      }
+      body_translate(platform, (vector_t){translation, 0});
+      platform_traits->interval = 0;
+    }
+  }
+}
+
+bool screen_in_level(state_t *state, int screen) {
+  return screen >= 0 && screen < (int)level_screens(state->level);
+}
+
 void control_special_platform_behavior(state_t *state, double dt) {
+  body_t *queen = get_queen(state);
   queen_traits_t *queen_traits =
-      (queen_traits_t *)((info_t *)body_get_info(state->queen))->traits;
+      (queen_traits_t *)((info_t *)body_get_info(queen))->traits;
   // applies slip friction (only when on slippery platform)
-  if (queen_traits->in_air && body_get_velocity(state->queen).x != 0 &&
-      ((info_t *)body_get_info(queen_traits->movement_medium))->type ==
-          SLIPPERY_PLATFORM) {
-    double friction_force_x = SLIP_FRICTION_CONSTANT *
-                              body_get_mass(state->queen) * LITTLE_G_CONSTANT;
-    if (body_get_velocity(state->queen).x > 0) {
+  if (queen_traits->in_air && body_get_velocity(queen).x != 0 &&
+      on_slippery_platform(state->scene, queen_traits)) {
+    double friction_force_x =
+        SLIP_FRICTION_CONSTANT * body_get_mass(queen) * LITTLE_G_CONSTANT;
+    if (body_get_velocity(queen).x > 0) {
       friction_force_x *= -1;
     }
-    body_add_force(state->queen, (vector_t){friction_force_x, 0});
+    body_add_force(queen, (vector_t){friction_force_x, 0});
   }
-  for (size_t i = 0; i < scene_bodies(state->scene); i++) {
-    body_t *platform = scene_get_body(state->scene, i);
-    info_t *info = body_get_info(platform);
-    platform_traits_t *platform_traits = (platform_traits_t *)info->traits;
-    if (info->type == MOVING_X_PLATFORM || info->type == MOVING_Y_PLATFORM) {
-      int direction = -1 * platform_outside_boundaries(platform);
-      if (direction) {
-        vector_t platform_velocity = body_get_velocity(platform);
-        if (!queen_traits->in_air && queen_traits->movement_medium == platform) {
-          body_set_velocity(state->queen,
-                            vec_subtract(body_get_velocity(state->queen),
-                                         vec_multiply(2.0, platform_velocity)));
-        }
-        vector_t unsigned_velocity = {fabs(platform_velocity.x),
-                                      fabs(platform_velocity.y)};
-        body_set_velocity(platform, vec_multiply(direction, unsigned_velocity));
-      }
-    } else if (info->type == DISAPPEARING_PLATFORM) {
-      platform_traits->interval += dt;
-      if (platform_traits->interval > APPERANCE_INTERVAL) {
-        double translation = WINDOW_WIDTH;
-        if (body_get_centroid(platform).x > WINDOW_WIDTH) {
-          translation *= -1;
-        }
-        body_translate(platform, (vector_t){translation, 0});
-        platform_traits->interval = 0;
+  // only the loaded screens have platforms in the scene
+  int current = state->screen_num - 1;
+  for (int s = current - 1; s <= current + 1; s++) {
+    if (!screen_in_level(state, s) || !state->screens[s].loaded) {
+      continue;
+    }
+    screen_t *screen = &state->screens[s];
+    for (size_t i = 0; i < screen->platform_count; i++) {
+      body_t *platform = scene_resolve(state->scene, screen->platforms[i]);
+      if (platform != NULL) {
+        update_special_platform(state, platform, dt);
       }
     }
   }
@@ -355,32 +414,32 @@ void control_special_platform_behavior(state_t *state, double dt) {
 
 void conditional_gravity(void *aux) {
   state_t *state = (state_t *)aux;
+  body_t *queen = get_queen(state);
   queen_traits_t *traits =
-      (queen_traits_t *)((info_t *)body_get_info(state->queen))->traits;
+      (queen_traits_t *)((info_t *)body_get_info(queen))->traits;
   traits->in_air = !traits->touching_bottom;
   // uncrouches once queen start jumping
   if (traits->in_air && traits->charging) {
     traits->charging = false;
-    queen_toggle_crouch(state->queen, false);
+    queen_toggle_crouch(queen, false);
   }
   if (!traits->in_air) {
     return;
   }
   traits->can_move_left = false;
   traits->can_move_right = false;
-  vector_t velocity = body_get_velocity(state->queen);
+  vector_t velocity = body_get_velocity(queen);
   if (velocity.y == -QUEEN_TERMINAL_VELOCITY * WINDOW_HEIGHT) {
     return;
   }
   if (velocity.y < -QUEEN_TERMINAL_VELOCITY * WINDOW_HEIGHT) {
-    body_set_velocity(
-        state->queen,
-        (vector_t){velocity.x, -QUEEN_TERMINAL_VELOCITY * WINDOW_HEIGHT});
+    body_set_velocity(queen, (vector_t){velocity.x, -QUEEN_TERMINAL_VELOCITY *
+                                                        WINDOW_HEIGHT});
     return;
   }
-  vector_t force = {0, -1 * body_get_mass(state->queen) * LITTLE_G_CONSTANT *
-                           WINDOW_HEIGHT};
-  body_add_force(state->queen, force);
+  vector_t force = {
+      0, -1 * body_get_mass(queen) * LITTLE_G_CONSTANT * WINDOW_HEIGHT};
+  body_add_force(queen, force);
 }
 
 void adjust_to_platform(body_t *queen, body_t *platform,
@@ -448,7 +507,7 @@ void platform_collide(bool last_tick_collision, body_t *queen, body_t *platform,
       }
 
       adjust_to_platform(queen, platform, BOTTOM);
-      queen_traits->movement_medium = platform;
+      queen_traits->movement_medium = body_get_handle(platform);
       // body_reset_force_and_impulse(queen);
       if (!last_tick_collision) {
         // commence face plant
@@ -456,8 +515,7 @@ void platform_collide(bool last_tick_collision, body_t *queen, body_t *platform,
           queen_traits->face_plant_timer = 0.00001;
         }
         if (platform_info->type != SLIPPERY_PLATFORM) {
-          body_set_velocity(queen,
-                            body_get_velocity(queen_traits->movement_medium));
+          body_set_velocity(queen, body_get_velocity(platform));
         } else {
           body_set_velocity(queen, (vector_t){body_get_velocity(queen).x, 0});
         }
@@ -508,6 +566,15 @@ void platform_collide(bool last_tick_collision, body_t *queen, body_t *platform,
   }
 }
 
+void add_platform_collision(state_t *state, body_t *platform) {
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, get_queen(state));
+  list_add(bodies, platform);
+  void *aux = physics_collision_aux_init(QUEEN_ELASTICITY);
+  create_collision(state->scene, bodies, platform_collide, aux,
+                   physics_collision_aux_free);
+}
+
 void make_platform_collisions(state_t *state) {
   for (size_t i = 0; i < scene_bodies(state->scene); i++) {
     body_t *platform = scene_get_body(state->scene, i);
@@ -515,281 +582,93 @@ void make_platform_collisions(state_t *state) {
     if (info->type == BACKGROUND || info->type == QUEEN) {
       continue;
     }
-    list_t *bodies = list_init(2, NULL);
-    list_add(bodies, state->queen);
-    list_add(bodies, platform);
-    void *aux = physics_collision_aux_init(QUEEN_ELASTICITY);
-    create_collision(state->scene, bodies, platform_collide, aux, free);
+    add_platform_collision(state, platform);
   }
 }
 
-void add_walls(scene_t *scene) {
+void add_walls(scene_t *scene, size_t screens) {
   // left wall
   add_stationary_platform(
       scene, VEC_ZERO,
-      vec_scale((vector_t){WALL_THICKNESS, SCREEN_COUNT}, WINDOW_DIM));
+      vec_scale((vector_t){WALL_THICKNESS, screens}, WINDOW_DIM));
   // right wall
   add_stationary_platform(
       scene, vec_scale((vector_t){1.0 - WALL_THICKNESS, 0}, WINDOW_DIM),
-      vec_scale((vector_t){1.0, SCREEN_COUNT}, WINDOW_DIM));
+      vec_scale((vector_t){1.0, screens}, WINDOW_DIM));
+}
+
+// adds a platform from the level file, which is in window units
+body_t *add_level_platform(scene_t *scene, const level_platform_t *platform) {
+  vector_t bottom_left = vec_scale(platform->bottom_left, WINDOW_DIM);
+  vector_t top_right = vec_scale(platform->top_right, WINDOW_DIM);
+  switch (platform->type) {
+  case LEVEL_MOVING_X:
+    return add_moving_platform(scene, bottom_left, top_right,
+                               platform->velocity.x * WINDOW_WIDTH,
+                               vec_multiply(WINDOW_WIDTH, platform->bounds),
+                               'x');
+  case LEVEL_MOVING_Y:
+    return add_moving_platform(scene, bottom_left, top_right,
+                               platform->velocity.y * WINDOW_HEIGHT,
+                               vec_multiply(WINDOW_HEIGHT, platform->bounds),
+                               'y');
+  case LEVEL_SLIPPERY:
+    return add_slippery_platform(scene, bottom_left, top_right);
+  case LEVEL_DISAPPEARING:
+    return add_disappearing_platform(scene, bottom_left, top_right);
+  default:
+    return add_stationary_platform(scene, bottom_left, top_right);
+  }
+}
+
+// adds a screen's platforms, and their collisions once the queen exists
+void load_screen(state_t *state, size_t index) {
+  screen_t *screen = &state->screens[index];
+  const level_platform_t *platforms =
+      level_screen_platforms(state->level, index, &screen->platform_count);
+  screen->platforms = malloc(screen->platform_count * sizeof(body_handle_t));
+  assert(screen->platform_count == 0 || screen->platforms != NULL);
+  body_t *queen = get_queen(state);
+  for (size_t i = 0; i < screen->platform_count; i++) {
+    body_t *platform = add_level_platform(state->scene, &platforms[i]);
+    screen->platforms[i] = body_get_handle(platform);
+    if (queen != NULL) {
+      add_platform_collision(state, platform);
+    }
+  }
+  screen->loaded = true;
 }
 
-void raise_screen_of_platforms(list_t *screen, size_t screen_number) {
-  if (screen_number == 0) {
-    return;
-  }
-  vector_t translation = (vector_t){0, screen_number * WINDOW_HEIGHT};
-  for (size_t i = 0; i < list_size(screen); i++) {
-    body_t *platform = (body_t *)list_get(screen, i);
-    info_t *info = (info_t *)body_get_info(platform);
-    body_translate(platform, translation);
-    if (info->type == MOVING_Y_PLATFORM) {
-      platform_traits_t *traits = (platform_traits_t *)info->traits;
-      vector_t new_bounds = {traits->bounds.x + translation.y,
-                             traits->bounds.y + translation.y};
-      traits->bounds = new_bounds;
-    }
+// removes a screen's platforms, which takes their collisions with them.
+// Moving and disappearing platforms start over if the screen is loaded again.
+void unload_screen(state_t *state, size_t index) {
+  screen_t *screen = &state->screens[index];
+  for (size_t i = 0; i < screen->platform_count; i++) {
+    scene_remove_handle(state->scene, screen->platforms[i]);
   }
-  list_free(screen);
+  free(screen->platforms);
+  screen->platforms = NULL;
+  screen->platform_count = 0;
+  screen->loaded = false;
 }
 
-void add_screen_1(scene_t *scene) {
-  // floor [0]
-  add_stationary_platform(
-      scene, VEC_ZERO, (vector_t){WINDOW_WIDTH, WINDOW_HEIGHT * FLOOR_HEIGHT});
-  // right bottom platform [1]
-  add_stationary_platform(
-      scene, vec_scale((vector_t){WALL_THICKNESS, FLOOR_HEIGHT}, WINDOW_DIM),
-      vec_scale((vector_t){650 / 2400.0, 875 / 1800.0}, WINDOW_DIM));
-  // left bottom platform [2]
-  add_stationary_platform(
-      scene, vec_scale((vector_t){1750 / 2400.0, FLOOR_HEIGHT}, WINDOW_DIM),
-      vec_scale((vector_t){1.0 - WALL_THICKNESS, 875 / 1800.0}, WINDOW_DIM));
-  // top mid platform [3]
-  add_stationary_platform(
-      scene, vec_scale((vector_t){925 / 2400.0, 1350 / 1800.0}, WINDOW_DIM),
-      vec_scale((vector_t){1475 / 2400.0, 1600 / 1800.0}, WINDOW_DIM));
-}
-
-void add_screen_2(scene_t *scene) {
-  list_t *screen = list_init(5, NULL);
-  // most bottom platform [0]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){1600 / 2400.0, 160 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1960 / 2400.0, 320 / 1800.0}, WINDOW_DIM)));
-  // most right platform [1]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){2040 / 2400.0, 640 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1.0 - WALL_THICKNESS, 810 / 1800.0},
-                         WINDOW_DIM)));
-  // bottom right middle platform [2]
-  list_add(
-      screen,
-      add_moving_platform(
-          scene, vec_scale((vector_t){700 / 2400.0, 640 / 1800.0}, WINDOW_DIM),
-          vec_scale((vector_t){1060 / 2400.0, 810 / 1800.0}, WINDOW_DIM),
-          MOVING_PLATFORM_VELOCITY.x * WINDOW_WIDTH,
-          vec_multiply(WINDOW_WIDTH, (vector_t){530 / 2400.0, 1550 / 2400.0}),
-          'x'));
-  // top left middle platform [3]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){600 / 2400.0, 1050 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){900 / 2400.0, 1290 / 1800.0}, WINDOW_DIM)));
-  // most top platform [4]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){WALL_THICKNESS, 900 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){410 / 2400.0, 1400 / 1800.0}, WINDOW_DIM)));
-  raise_screen_of_platforms(screen, 1);
-}
-
-void add_screen_3(scene_t *scene) {
-  list_t *screen = list_init(9, NULL);
-  // bottom left platform [0]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){1040 / 2400.0, 200 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1280 / 2400.0, 280 / 1800.0}, WINDOW_DIM)));
-  // bottom right platform [1]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){1600 / 2400.0, 200 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1880 / 2400.0, 280 / 1800.0}, WINDOW_DIM)));
-  // most right platfotm [2]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){2120 / 2400.0, 440 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1.0 - WALL_THICKNESS, 530 / 1800.0},
-                         WINDOW_DIM)));
-  // middle stationary platform [3]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){960 / 2400.0, 510 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1640 / 2400.0, 610 / 1800.0}, WINDOW_DIM)));
-  // right moving platform [4]
-  list_add(
-      screen,
-      add_moving_platform(
-          scene,
-          vec_scale((vector_t){1250 / 2400.0, 1140 / 1800.0}, WINDOW_DIM),
-          vec_scale((vector_t){1690 / 2400.0, 1250 / 1800.0}, WINDOW_DIM),
-          -MOVING_PLATFORM_VELOCITY.y * WINDOW_HEIGHT,
-          vec_multiply(WINDOW_HEIGHT, (vector_t){770 / 1800.0, 1250 / 1800.0}),
-          'y'));
-  // left moving platform [5]
-  list_add(
-      screen,
-      add_moving_platform(
-          scene, vec_scale((vector_t){700 / 2400.0, 980 / 1800.0}, WINDOW_DIM),
-          vec_scale((vector_t){920 / 2400.0, 1180 / 1800.0}, WINDOW_DIM),
-          MOVING_PLATFORM_VELOCITY.y * WINDOW_HEIGHT,
-          vec_multiply(WINDOW_HEIGHT, (vector_t){980 / 1800.0, 1550 / 1800.0}),
-          'y'));
-  // most right platform [6]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){WALL_THICKNESS, 1230 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){310 / 2400.0, 1310 / 1800.0}, WINDOW_DIM)));
-  // top left platform [7]
-  list_add(
-      screen,
-      add_stationary_platform(
-          scene, vec_scale((vector_t){690 / 2400.0, 1710 / 1800.0}, WINDOW_DIM),
-          vec_scale((vector_t){1030 / 2400.0, 2000 / 1800.0}, WINDOW_DIM)));
-  // top right platform [8]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){2250 / 2400.0, 1760 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1.0 - WALL_THICKNESS, 1840 / 1800.0},
-                         WINDOW_DIM)));
-  raise_screen_of_platforms(screen, 2);
-}
-
-void add_screen_4(scene_t *scene) {
-  list_t *screen = list_init(8, NULL);
-  // bottom left middle platform [0]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){1400 / 2400.0, 520 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1600 / 2400.0, 600 / 1800.0}, WINDOW_DIM)));
-  // most left platform [1]
-  list_add(screen,
-           add_stationary_platform(
-               scene,
-               vec_scale((vector_t){WALL_THICKNESS, 520 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){200 / 2400.0, 600 / 1800.0}, WINDOW_DIM)));
-  // middle right moving platform [2]
-  list_add(screen,
-           add_moving_platform(
-               scene,
-               vec_scale((vector_t){2040 / 2400.0, 920 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){2200 / 2400.0, 1000 / 1800.0}, WINDOW_DIM),
-               -MOVING_PLATFORM_VELOCITY.y * WINDOW_HEIGHT,
-               vec_multiply(WINDOW_WIDTH,
-                            (vector_t){1650 / 2400.0, 1.0 - WALL_THICKNESS -
-                                                          1.1 * QUEEN_DIM.x}),
-               'x'));
-  // right step platform [3]
-  list_add(
-      screen,
-      add_stationary_platform(
-          scene,
-          vec_scale((vector_t){1240 / 2400.0, 1300 / 1800.0}, WINDOW_DIM),
-          vec_scale((vector_t){1400 / 2400.0, 1360 / 1800.0}, WINDOW_DIM)));
-  // middle step platform [4]
-  list_add(
-      screen,
-      add_disappearing_platform(
-          scene, vec_scale((vector_t){930 / 2400.0, 1380 / 1800.0}, WINDOW_DIM),
-          vec_scale((vector_t){1090 / 2400.0, 1440 / 1800.0}, WINDOW_DIM)));
-  // left step platform [5]
-  list_add(screen,
-           add_slippery_platform(
-               scene,
-               vec_scale((vector_t){610 / 2400.0, 1460 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){770 / 2400.0, 1520 / 1800.0}, WINDOW_DIM)));
-  // top tall thin platform [6]
-  list_add(screen,
-           add_slippery_platform(
-               scene,
-               vec_scale((vector_t){570 / 2400.0, 1460 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){610 / 2400.0, 2420 / 1800.0}, WINDOW_DIM)));
-  // top right platform [7]
-  list_add(
-      screen,
-      add_slippery_platform(
-          scene,
-          vec_scale((vector_t){1020 / 2400.0, 1720 / 1800.0}, WINDOW_DIM),
-          vec_scale((vector_t){1860 / 2400.0, 1840 / 1800.0}, WINDOW_DIM)));
-  // top most right platform [8]
-  list_add(
-      screen,
-      add_slippery_platform(
-          scene,
-          vec_scale((vector_t){2200 / 2400.0, 1775 / 1800.0}, WINDOW_DIM),
-          vec_scale((vector_t){1.0-WALL_THICKNESS, 1880 / 1800.0}, WINDOW_DIM)));
-  raise_screen_of_platforms(screen, 3);
-}
-
-void add_screen_5(scene_t *scene) {
-  list_t *screen = list_init(8, NULL);
-  // bottom right platform [0]
-  list_add(screen,
-           add_slippery_platform(
-               scene,
-               vec_scale((vector_t){2150 / 2400.0, 80 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1.0-WALL_THICKNESS, 200 / 1800.0}, WINDOW_DIM)));
-  // middle right platform [1]
-  list_add(screen,
-           add_slippery_platform(
-               scene,
-               vec_scale((vector_t){2200 / 2400.0, 600 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1.0-WALL_THICKNESS, 750 / 1800.0}, WINDOW_DIM)));
-  // middle bottom platform [2]
-  list_add(screen,
-           add_slippery_platform(
-               scene,
-               vec_scale((vector_t){760 / 2400.0, 460 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1180 / 2400.0, 590 / 1800.0}, WINDOW_DIM)));
-  // bottom left platform [3]
-  list_add(screen,
-           add_slippery_platform(
-               scene,
-               vec_scale((vector_t){200 / 2400.0, 300 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){360 / 2400.0, 360 / 1800.0}, WINDOW_DIM)));
-  // most middle platform [4]
-  list_add(screen,
-           add_slippery_platform(
-               scene,
-               vec_scale((vector_t){830 / 2400.0, 960 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1060 / 2400.0, 1090 / 1800.0}, WINDOW_DIM)));
-  // top right platform [5]
-  list_add(screen,
-           add_slippery_platform(
-               scene,
-               vec_scale((vector_t){1870 / 2400.0, 1230 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){2000 / 2400.0, 1360 / 1800.0}, WINDOW_DIM)));
-  // top right platform [6]
-  list_add(screen,
-           add_slippery_platform(
-               scene,
-               vec_scale((vector_t){1400 / 2400.0, 1360 / 1800.0}, WINDOW_DIM),
-               vec_scale((vector_t){1630 / 2400.0, 1490 / 1800.0}, WINDOW_DIM)));
-  raise_screen_of_platforms(screen, 4);
+// keeps the screen the queen is on and the ones next to it in the scene,
+// so the scene's size does not depend on the size of the level.
+// The queen changes screens one at a time, so only the screens two away
+// can have just left that window.
+void page_screens(state_t *state) {
+  int current = state->screen_num - 1;
+  for (int screen = current - 2; screen <= current + 2; screen++) {
+    if (!screen_in_level(state, screen)) {
+      continue;
+    }
+    bool near = abs(screen - current) <= 1;
+    if (near && !state->screens[screen].loaded) {
+      load_screen(state, screen);
+    } else if (!near && state->screens[screen].loaded) {
+      unload_screen(state, screen);
+    }
+  }
 }
 
 void toggle_pause(state_t *state) {
@@ -803,7 +682,8 @@ void toggle_pause(state_t *state) {
 }
 
 // direction = 1 is right, direction = -1 is left
-void queen_move(body_t *queen, key_event_type_t type, int direction) {
+void queen_move(state_t *state, key_event_type_t type, int direction) {
+  body_t *queen = get_queen(state);
   queen_traits_t *traits =
       (queen_traits_t *)((info_t *)body_get_info(queen))->traits;
   if (type == KEY_PRESSED) {
@@ -825,8 +705,7 @@ void queen_move(body_t *queen, key_event_type_t type, int direction) {
   }
 
   // for slippery movement (only when on slippery platform)
-  if (((info_t *)body_get_info(traits->movement_medium))->type ==
-      SLIPPERY_PLATFORM) {
+  if (on_slippery_platform(state->scene, traits)) {
     if (type == KEY_PRESSED) {
       // get closer to ideal movement
       double movement_force_x = direction * SLIP_ACCELERATION_MAGNITUDE *
@@ -839,14 +718,15 @@ void queen_move(body_t *queen, key_event_type_t type, int direction) {
   // for normal movement
   if (type == KEY_PRESSED) {
     body_set_velocity(
-        queen, vec_add(body_get_velocity(traits->movement_medium),
+        queen, vec_add(get_medium_velocity(state->scene, traits),
                        (vector_t){direction * QUEEN_SPEED * WINDOW_WIDTH, 0}));
   } else {
-    body_set_velocity(queen, body_get_velocity(traits->movement_medium));
+    body_set_velocity(queen, get_medium_velocity(state->scene, traits));
   }
 }
 
-bool queen_jump(body_t *queen, bool keyed, key_event_type_t type) {
+bool queen_jump(state_t *state, bool keyed, key_event_type_t type) {
+  body_t *queen = get_queen(state);
   queen_traits_t *traits =
       (queen_traits_t *)((info_t *)body_get_info(queen))->traits;
   if (traits->in_air) {
@@ -856,7 +736,7 @@ bool queen_jump(body_t *queen, bool keyed, key_event_type_t type) {
     if (!traits->charging) {
       traits->charging = true;
       queen_toggle_crouch(queen, true);
-      body_set_velocity(queen, body_get_velocity(traits->movement_medium));
+      body_set_velocity(queen, get_medium_velocity(state->scene, traits));
       traits->jump_charge_timer = 0;
     }
   }
@@ -877,8 +757,7 @@ bool queen_jump(body_t *queen, bool keyed, key_event_type_t type) {
   return false;
 }
 
-void on_key(char key, key_event_type_t type, double held_time, void *stat) {
-  state_t *state = (state_t *)stat;
+void handle_key(state_t *state, char key, key_event_type_t type) {
   if (key == P_KEY && type == KEY_PRESSED) {
     toggle_pause(state);
     return;
@@ -892,16 +771,25 @@ void on_key(char key, key_event_type_t type, double held_time, void *stat) {
     return;
   }
   if (key == SPACE_BAR) {
-    if (queen_jump(state->queen, true, type))
+    if (queen_jump(state, true, type))
       return;
   } else {
-    if (queen_jump(state->queen, false, type))
+    if (queen_jump(state, false, type))
       return;
   }
   if (key == RIGHT_ARROW) {
-    queen_move(state->queen, type, 1);
+    queen_move(state, type, 1);
   } else if (key == LEFT_ARROW) {
-    queen_move(state->queen, type, -1);
+    queen_move(state, type, -1);
+  }
+}
+
+// handles every key event since the last tick here, instead of in a callback
+void handle_input(state_t *state) {
+  size_t event_count;
+  const key_event_t *events = sdl_key_events(&event_count);
+  for (size_t i = 0; i < event_count; i++) {
+    handle_key(state, events[i].key, events[i].type);
   }
 }
 
@@ -911,80 +799,74 @@ void win(state_t *state) {
   body_t *win_star =
       body_init(make_star(WIN_STAR_POINTS, WIN_STAR_INNER_RADIUS,
                           WIN_STAR_OUTER_TO_INNER_RATIO * WIN_STAR_INNER_RADIUS,
-                          WINDOW_CENTER, 0),
+                          vec_add(WINDOW_CENTER, sdl_get_camera()), 0),
                 0, WIN_STAR_COLOR);
   scene_add_body(state->scene, win_star);
 }
 
 bool check_screen_transition(state_t *state) {
-  double queen_top_coord = get_coordinate(state->queen, TOP);
-  double queen_bottom_coord = get_coordinate(state->queen, BOTTOM);
-  if (queen_top_coord > SCREEN_COUNT * WINDOW_HEIGHT) {
+  body_t *queen = get_queen(state);
+  double queen_top_coord = get_coordinate(queen, TOP);
+  double queen_bottom_coord = get_coordinate(queen, BOTTOM);
+  if (queen_top_coord > level_screens(state->level) * WINDOW_HEIGHT) {
     win(state);
     return false;
   }
-  double translation_mag = 0;
-  if (queen_bottom_coord > WINDOW_HEIGHT) {
-    translation_mag = -WINDOW_HEIGHT;
+  // bodies stay put; only the camera follows the queen between screens
+  double screen_bottom = (state->screen_num - 1) * WINDOW_HEIGHT;
+  if (queen_bottom_coord > screen_bottom + WINDOW_HEIGHT) {
     state->screen_num++;
-  } else if (queen_top_coord < 0) {
-    translation_mag = WINDOW_HEIGHT;
+  } else if (queen_top_coord < screen_bottom) {
     state->screen_num--;
+  } else {
+    return false;
   }
-  if (translation_mag != 0) {
-    for (size_t i = 0; i < scene_bodies(state->scene); i++) {
-      body_t *body = scene_get_body(state->scene, i);
-      info_t *info = body_get_info(body);
-      if (info->type == BACKGROUND) {
-        continue;
-      }
-      body_translate(body, (vector_t){0, translation_mag});
-      if (info->type == MOVING_Y_PLATFORM) {
-        platform_traits_t *traits = (platform_traits_t *)info->traits;
-        vector_t new_bounds = {traits->bounds.x + translation_mag,
-                               traits->bounds.y + translation_mag};
-        traits->bounds = new_bounds;
-      }
-    }
-    return true;
-    // body_set_color(state->background, r_color());
-  }
-  return false;
+  sdl_set_camera((vector_t){0, (state->screen_num - 1) * WINDOW_HEIGHT});
+  return true;
 }
 
 state_t *emscripten_init() {
-  srand(time(NULL));
+  r_seed(sdl_random_seed());
   sdl_init(VEC_ZERO, (vector_t){WINDOW_WIDTH, WINDOW_HEIGHT});
   state_t *state = malloc(sizeof(state_t));
   state->scene = scene_init();
+  // stationary platforms are never integrated while sleeping is enabled
+  scene_set_sleep(state->scene, SLEEP_VELOCITY * WINDOW_HEIGHT, TIME_TO_SLEEP);
   state->status = PLAY;
   state->screen_num = 1;
+  state->queen = BODY_HANDLE_NULL;
+  state->level = level_open(LEVEL_PATH);
+  if (state->level == NULL) {
+    fprintf(stderr, "could not read the level file %s\n", LEVEL_PATH);
+  }
+  assert(state->level != NULL);
+  state->screens = calloc(level_screens(state->level), sizeof(screen_t));
+  assert(state->screens != NULL);
   add_background(state);
-  add_walls(state->scene);
-  add_screen_1(state->scene);
-  add_screen_2(state->scene);
-  add_screen_3(state->scene);
-  add_screen_4(state->scene);
-  add_screen_5(state->scene);
+  add_walls(state->scene, level_screens(state->level));
+  page_screens(state);
   add_queen_hitbox(state);
   scene_add_bodies_force_creator(state->scene, conditional_gravity, state, NULL,
                                  (free_func_t)free);
+  make_platform_collisions(state);
   while (check_screen_transition(state)) {
-    ;
+    page_screens(state);
   }
-  make_platform_collisions(state);
-  sdl_on_key((void *)on_key);
   return state;
 }
 
 void emscripten_main(state_t *state) {
   double dt = time_since_last_tick();
+  handle_input(state);
   if (state->status == PLAY) {
     control_special_platform_behavior(state, dt);
-    queen_zero_flags(state->queen);
+    queen_zero_flags(get_queen(state));
     scene_tick(state->scene, dt);
-    check_screen_transition(state);
-    queen_traits_t *traits = ((info_t *)body_get_info(state->queen))->traits;
+    if (check_screen_transition(state)) {
+      page_screens(state);
+    }
+    queen_traits_t *traits =
+        ((info_t *)body_get_info(get_queen(state)))->traits;
     if (traits->charging) {
       traits->jump_charge_timer += dt;
     }
@@ -1003,6 +885,11 @@ void emscripten_main(state_t *state) {
 }
 
 void emscripten_free(state_t *state) {
+  for (size_t i = 0; i < level_screens(state->level); i++) {
+    free(state->screens[i].platforms);
+  }
+  free(state->screens);
+  level_close(state->level);
+  // the gravity force creator owns the state, so this frees it too
   scene_free(state->scene);
-  free(state);
 }
\ No newline at end of file
@@ -1,12 +1,12 @@
 #include "forces.h"
 #include "list.h"
 #include "polygon.h"
+#include "random.h"
 #include "scene.h"
 #include "sdl_wrapper.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
 
 #define CIRCLE_POINTS 40
 
@@ -30,6 +30,9 @@
 
 #define BALL_MASS 2.0
 
+#define SLEEP_VELOCITY 0.05 // m / s
+#define TIME_TO_SLEEP 0.5   // s
+
 #define BALL_COLOR ((rgb_color_t){1, 0, 0})
 #define PEG_COLOR ((rgb_color_t){0, 1, 0})
 #define WALL_COLOR ((rgb_color_t){0, 0, 1})
@@ -56,9 +59,6 @@ body_type_t get_type(body_t *body) {
   return *(body_type_t *)body_get_info(body);
 }
 
-/** Generates a random number between 0 and 1 */
-double rand_double(void) { return (double)rand() / RAND_MAX; }
-
 /** Constructs a rectangle with the given dimensions centered at (0, 0) */
 list_t *rect_init(double width, double height) {
   vector_t half_width = {.x = width / 2, .y = 0.0},
@@ -158,7 +158,7 @@ void freeze(bool last_tick_collision, body_t *ball, body_t *target,
 /** Adds a ball to the scene */
 void add_ball(scene_t *scene) {
   // Add the ball to the scene.
-  vector_t ball_center = {.x = MAX.x / 2 + (rand_double() - 0.5) * DELTA_X,
+  vector_t ball_center = {.x = MAX.x / 2 + r_double(-0.5, 0.5) * DELTA_X,
                           .y = DROP_Y};
   body_t *ball = get_ball(ball_center, START_VELOCITY);
   size_t body_count = scene_bodies(scene);
@@ -253,10 +253,12 @@ typedef struct state {
 } state_t;
 
 state_t *emscripten_init(void) {
-  srand(time(NULL));
+  r_seed(sdl_random_seed());
   // Initialize scene
   sdl_init(VEC_ZERO, MAX);
   scene_t *scene = scene_init();
+  // Settled balls and the pegs stop costing anything once they are at rest
+  scene_set_sleep(scene, SLEEP_VELOCITY, TIME_TO_SLEEP);
   // Add elements to the scene
   add_gravity_body(scene);
   add_pegs(scene);
@@ -28,6 +28,8 @@ const rgb_color_t PLAYER_LASER_COLOR = {1, 1, 1};
 const vector_t LASER_DIMENSIONS = {SIZE_FACTOR * 2, SIZE_FACTOR * 8};
 const double ENEMY_LASER_SPEED = 200;
 const double PLAYER_LASER_SPEED = 250;
+// lets lasers substep instead of tunneling through the thin blockade cells
+const size_t MAX_SUBSTEPS = 8;
 
 const double BLOCKADE_MASS = 100;
 const size_t BLOCKADE_THICKNESS = 7;
@@ -101,8 +103,8 @@ body_t *make_laser(body_type_t type, vector_t center, rgb_color_t color,
 
 body_t *make_enemy(vector_t center, rgb_color_t color) {
   list_t *shape = make_closed_polygon(0.5 * ENEMY_HEIGHT, 6);
-  free(list_remove(shape, 5));
-  free(list_remove(shape, 1));
+  vec_free(list_remove(shape, 5));
+  vec_free(list_remove(shape, 1));
   void *info = info_init(ENEMY, r_double(0, ENEMY_RELOAD_SPEED));
   body_t *enemy = body_init_with_info(shape, ENEMY_MASS, color, info, free);
   body_set_centroid(enemy, center);
@@ -315,10 +317,11 @@ void lose(state_t *state) {
 }
 
 state_t *emscripten_init() {
-  srand(time(NULL));
+  r_seed(sdl_random_seed());
   sdl_init(VEC_ZERO, (vector_t){WINDOW_WIDTH, WINDOW_HEIGHT});
   state_t *state = malloc(sizeof(state_t));
   state->scene = scene_init();
+  scene_set_substepping(state->scene, MAX_SUBSTEPS);
   state->end_game = 0;
   // adds background
   void *bg_info = info_init(BACKGROUND, 0);
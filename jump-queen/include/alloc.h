@@ -0,0 +1,108 @@
+#ifndef __ALLOC_H__
+#define __ALLOC_H__
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * The engine's allocator. The core library (lists, pools, arenas, bodies,
+ * forces, scenes and integrators) allocates through these functions instead
+ * of malloc(), so that its allocations can be counted while it runs, e.g.
+ * to check that a scene stops allocating once it reaches a steady state.
+ *
+ * Every allocation is tagged with the part of the engine it is for.
+ * Memory from engine_malloc() must be released with engine_free(),
+ * never free(), and the other way around.
+ */
+typedef enum {
+  ALLOC_OTHER,
+  ALLOC_LIST,  // list data arrays too big for the list pools
+  ALLOC_POOL,  // pools and their chunks
+  ALLOC_ARENA, // arenas and their blocks
+  ALLOC_BODY,  // vertex buffers for saving and loading bodies
+  ALLOC_FORCE, // force appliers, spring networks and force kinds
+  ALLOC_SCENE, // scenes and their per-body arrays, e.g. integrator scratch
+  ALLOC_TAGS   // the number of tags
+} alloc_tag_t;
+
+/**
+ * The allocations made for one tag since the counts were last reset.
+ * live_bytes and peak_bytes are for memory that is still allocated,
+ * so they are not cleared by alloc_reset_stats().
+ */
+typedef struct {
+  size_t allocations; // calls that allocated or moved memory
+  size_t frees;       // calls that released memory
+  size_t bytes;       // bytes requested by those allocations
+  size_t live_bytes;  // bytes allocated and not yet released
+  size_t peak_bytes;  // the most live_bytes there have been
+} alloc_stats_t;
+
+/**
+ * Allocates memory, like malloc().
+ * Asserts that the memory is successfully allocated.
+ *
+ * @param size the number of bytes to allocate
+ * @param tag what the memory is for
+ * @return memory suitably aligned for any type
+ */
+void *engine_malloc(size_t size, alloc_tag_t tag);
+
+/**
+ * Resizes memory from engine_malloc(), like realloc().
+ * Asserts that the memory is successfully allocated.
+ *
+ * @param memory memory returned from engine_malloc() or engine_realloc(),
+ *   or NULL to allocate new memory
+ * @param size the number of bytes the memory should hold
+ * @param tag what the memory is for
+ * @return the resized memory, which may have moved
+ */
+void *engine_realloc(void *memory, size_t size, alloc_tag_t tag);
+
+/**
+ * Releases memory from engine_malloc() or engine_realloc(), like free().
+ *
+ * @param memory the memory to release, or NULL to do nothing
+ */
+void engine_free(void *memory);
+
+/**
+ * Gets the allocations made for one tag.
+ *
+ * @param tag the tag to look up
+ * @return its counts
+ */
+alloc_stats_t alloc_get_stats(alloc_tag_t tag);
+
+/**
+ * Gets the allocations made for all tags together.
+ * peak_bytes is the most memory there has been live at once.
+ *
+ * @return the sums of every tag's counts
+ */
+alloc_stats_t alloc_total_stats(void);
+
+/**
+ * Clears the counts of allocations, frees and bytes allocated,
+ * and lowers each peak to the memory that is live now.
+ * Used to count what a stretch of code allocates, e.g. one scene_tick().
+ */
+void alloc_reset_stats(void);
+
+/**
+ * Gets a tag's name, as used in reports.
+ *
+ * @param tag the tag to look up
+ * @return a short lowercase name, e.g. "list"
+ */
+const char *alloc_tag_name(alloc_tag_t tag);
+
+/**
+ * Prints every tag's counts that are not all zero.
+ *
+ * @param file where to print the report
+ */
+void alloc_report(FILE *file);
+
+#endif // #ifndef __ALLOC_H__
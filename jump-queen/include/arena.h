@@ -0,0 +1,93 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+/**
+ * A bump allocator for short-lived memory.
+ * Allocations are carved out of one large block and are never freed
+ * individually; instead the whole arena is reset (or rewound to a mark)
+ * at once. If a block runs out, a bigger one is chained on, and the next
+ * reset replaces the chain with a single block large enough for all of it,
+ * so an arena reaches a steady state that never calls malloc().
+ */
+typedef struct arena arena_t;
+
+/**
+ * A position in an arena, returned from arena_mark().
+ */
+typedef size_t arena_mark_t;
+
+/**
+ * Allocates memory for an empty arena.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param capacity the number of bytes to reserve up front
+ * @return the new arena
+ */
+arena_t *arena_init(size_t capacity);
+
+/**
+ * Releases the memory allocated for an arena,
+ * including everything allocated from it.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_free(arena_t *arena);
+
+/**
+ * Allocates memory from an arena, suitably aligned for any type.
+ * The memory is valid until the arena is reset or rewound past it.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param size the number of bytes to allocate
+ * @return a pointer to the allocated memory
+ */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+ * Frees everything allocated from an arena at once.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_reset(arena_t *arena);
+
+/**
+ * Records the current position in an arena so that the allocations made
+ * after it can be freed with arena_rewind().
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the current position
+ */
+arena_mark_t arena_mark(arena_t *arena);
+
+/**
+ * Frees everything allocated from an arena since a mark.
+ * If the arena had to grow since the mark, the memory in its older blocks
+ * is only reclaimed by the next reset.
+ * Rewinding to a mark taken before the last reset is not allowed.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param mark a mark returned from arena_mark()
+ */
+void arena_rewind(arena_t *arena, arena_mark_t mark);
+
+/**
+ * Gets the number of bytes currently allocated from an arena.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the number of bytes in use, including alignment padding
+ */
+size_t arena_used(arena_t *arena);
+
+/**
+ * Gets the engine's per-frame arena, creating it on first use.
+ * It is reset at the start of every scene_tick(), so anything allocated
+ * from it must not be kept past the current frame.
+ *
+ * @return the frame arena
+ */
+arena_t *frame_arena(void);
+
+#endif // #ifndef __ARENA_H__
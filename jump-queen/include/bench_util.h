@@ -0,0 +1,51 @@
+/** Common functions for microbenchmarks. */
+
+#ifndef __BENCH_UTIL_H__
+#define __BENCH_UTIL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * The operation being measured: runs it `iterations` times in a row.
+ * Anything that only needs to happen once (building shapes, scenes, ...)
+ * belongs outside it, in the state it is passed.
+ */
+typedef void (*bench_op_t)(void *state, size_t iterations);
+
+/**
+ * Measures an operation and prints the result as one line of JSON.
+ *
+ * First doubles the number of iterations per sample until a sample takes
+ * at least BENCH_SAMPLE_NS (default 100000) nanoseconds, which also warms up
+ * caches and pools. Then times BENCH_SAMPLES (default 50) samples and prints
+ *   {"name": ..., "iterations": ..., "median": ..., "p90": ..., "p99": ...,
+ *    "min": ..., "mean": ..., "samples": [...]}
+ * where every time is in nanoseconds per iteration, read with profile_now().
+ *
+ * If BENCH_FILTER is set, only benchmarks whose names contain it are run.
+ * BENCH_SAMPLES, BENCH_SAMPLE_NS and BENCH_FILTER are environment variables.
+ *
+ * @param name the benchmark's name, e.g. "find_collision/16/overlap"
+ * @param op the operation to measure
+ * @param state passed to every call to op
+ */
+void bench_run(const char *name, bench_op_t op, void *state);
+
+/**
+ * Checks whether a benchmark is selected by BENCH_FILTER, as bench_run() does.
+ * Lets a benchmark skip expensive setup that only it needs.
+ *
+ * @param name the benchmark's name
+ * @return false if BENCH_FILTER is set and name does not contain it
+ */
+bool bench_selected(const char *name);
+
+/**
+ * Keeps the compiler from optimizing away a value that is never used.
+ *
+ * @param value the value that must be computed
+ */
+void bench_use(double value);
+
+#endif // #ifndef __BENCH_UTIL_H__
@@ -5,6 +5,8 @@
 #include "list.h"
 #include "vector.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 
 /**
  * A rigid body constrained to the plane.
@@ -14,6 +16,24 @@
  */
 typedef struct body body_t;
 
+/**
+ * A weak reference to a body in a scene.
+ * The index is the body's slot in the scene and the generation counts how many
+ * bodies have used that slot, so a handle to a removed body never resolves to
+ * the body that reuses its slot. See scene_resolve().
+ */
+typedef struct body_handle {
+  uint32_t index;
+  uint32_t generation;
+} body_handle_t;
+
+/**
+ * A handle that never refers to a body; generations start at 1.
+ * You will need to define "const body_handle_t BODY_HANDLE_NULL = ..." in
+ * body.c.
+ */
+extern const body_handle_t BODY_HANDLE_NULL;
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL.
@@ -51,9 +71,21 @@ void body_free(body_t *body);
  */
 void *body_get_info(body_t *body);
 
+/**
+ * Replaces the information associated with a body,
+ * freeing the old info with its freer if it has one.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param info the new info
+ * @param info_freer if non-NULL, a function call on the info to free it
+ */
+void body_set_info(body_t *body, void *info, free_func_t info_freer);
+
 /**
  * Gets the current shape of a body.
  * Returns a newly allocated vector list, which must be list_free()d.
+ * Its vertices come from vec_alloc(), so any removed from the list must be
+ * released with vec_free(), not free().
  *
  * @param body a pointer to a body returned from body_init()
  * @return a copy of body's shape describing the body's current position
@@ -112,6 +144,24 @@ double body_get_rotation(body_t *body);
  */
 double body_get_angular_velocity(body_t *body);
 
+/**
+ * Gets the radius of the smallest circle around the body's centroid
+ * that contains its whole shape.
+ * Kept up to date by body_dilate*(); must be refreshed with
+ * body_update_radius() after editing the shape from body_get_real_shape().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's bounding radius
+ */
+double body_get_radius(body_t *body);
+
+/**
+ * Recomputes the bounding radius of a body from its shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_update_radius(body_t *body);
+
 /**
  * Gets the current velocity of a body.
  *
@@ -128,6 +178,22 @@ vector_t body_get_velocity(body_t *body);
  */
 vector_t body_get_acceleration(body_t *body);
 
+/**
+ * Gets the total force applied to a body so far this tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the sum of the forces added with body_add_force()
+ */
+vector_t body_get_force(body_t *body);
+
+/**
+ * Gets the total impulse applied to a body so far this tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the sum of the impulses added with body_add_impulse()
+ */
+vector_t body_get_impulse(body_t *body);
+
 /**
  * Sets the color of a body.
  *
@@ -175,6 +241,8 @@ void body_set_angular_velocity(body_t *body, double velocity);
 
 /**
  * Changes a body's velocity (the time-derivative of its position).
+ * Also clears the body's acceleration, which described how it reached
+ * its old velocity.
  *
  * @param body a pointer to a body returned from body_init()
  * @param v the body's new velocity
@@ -294,4 +362,174 @@ bool body_is_removable(body_t *body);
  */
 void body_set_removability(body_t *body, bool removable);
 
+/**
+ * Returns whether a body can never move on its own:
+ * it has infinite (or zero) mass and is neither moving nor rotating.
+ * Immovable bodies are never integrated by a scene with sleeping enabled.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether the body is immovable
+ */
+bool body_is_immovable(body_t *body);
+
+/**
+ * Gets a counter that changes whenever an immovable body may look different:
+ * when one is moved, turned, resized, recolored or freed, when a body starts
+ * or stops being immovable, or when body_mark_static_changed() is called.
+ * Renderers can keep immovable bodies drawn until it changes.
+ *
+ * @return the number of such changes so far
+ */
+size_t body_static_version(void);
+
+/**
+ * Changes body_static_version() if the body is immovable.
+ * For changes the body cannot see itself, e.g. being added to a scene.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_mark_static_changed(body_t *body);
+
+/**
+ * Returns whether a body is asleep.
+ * Sleeping bodies are skipped by scene_tick() until they are woken up.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether the body is sleeping
+ */
+bool body_is_sleeping(body_t *body);
+
+/**
+ * Puts a body to sleep, stopping it in place and clearing its acceleration.
+ * Does nothing if the body has been made unable to sleep.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_sleep(body_t *body);
+
+/**
+ * Wakes a sleeping body up, restarting its rest timer and clearing its
+ * acceleration.
+ * Adding a force or impulse or setting the velocity wakes a body automatically.
+ * If the body is already awake, does nothing.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_wake(body_t *body);
+
+/**
+ * Gets if the body can be put to sleep.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether the body can sleep
+ */
+bool body_can_sleep(body_t *body);
+
+/**
+ * Sets if the body can be put to sleep (true by default).
+ * Player-controlled bodies should usually never sleep.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param sleepable the body's new ability to sleep
+ */
+void body_set_sleepability(body_t *body, bool sleepable);
+
+/**
+ * Updates how long the body has been (nearly) at rest.
+ * The rest time grows by dt while the body's speed is below the threshold
+ * and resets to 0 as soon as it moves faster.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param dt the number of seconds elapsed since the last update
+ * @param threshold the speed below which the body counts as resting
+ * @return the number of seconds the body has been resting
+ */
+double body_update_rest_time(body_t *body, double dt, double threshold);
+
+/**
+ * Gets whether the body is (nearly) at rest right now: its speed, counting
+ * any impulse added since the last tick, is below the threshold.
+ * A body that has rested long enough to sleep may have just been hit or
+ * had its velocity set, so this is checked again before it is put to sleep.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param threshold the speed below which the body counts as resting
+ * @return whether the body is resting
+ */
+bool body_is_resting(body_t *body, double threshold);
+
+/**
+ * Gets how long the body has been (nearly) at rest,
+ * as of the last call to body_update_rest_time().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the number of seconds the body has been resting
+ */
+double body_get_rest_time(body_t *body);
+
+/**
+ * Gets the island (group of touching bodies) a body was last assigned to.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's island index
+ */
+size_t body_get_island(body_t *body);
+
+/**
+ * Assigns a body to an island (group of touching bodies).
+ * Used by the scene while grouping bodies for sleeping.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param island the body's new island index
+ */
+void body_set_island(body_t *body, size_t island);
+
+/**
+ * Gets the handle of a body, assigned when it is added to a scene.
+ * Bodies outside any scene have BODY_HANDLE_NULL.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's handle
+ */
+body_handle_t body_get_handle(body_t *body);
+
+/**
+ * Assigns a handle to a body. Used by the scene when the body is added.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param handle the body's new handle
+ */
+void body_set_handle(body_t *body, body_handle_t handle);
+
+/**
+ * Gets whether two handles refer to the same body.
+ *
+ * @param a a body handle
+ * @param b another body handle
+ * @return true if the handles are equal
+ */
+bool body_handle_equal(body_handle_t a, body_handle_t b);
+
+/**
+ * Writes a body's shape and physical state to a binary file.
+ * The fixed-size state is written as one record followed by the vertices
+ * as one array. The info is not written; see scene_save().
+ * The format is native-endian and only meant to be read on the same platform.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param file the file to write to
+ * @return false if the body could not be written
+ */
+bool body_save(body_t *body, FILE *file);
+
+/**
+ * Reads a body written by body_save(). The body has no info.
+ * Its handle is the one it had when saved, which is only meaningful
+ * to the scene it is restored into.
+ *
+ * @param file the file to read from
+ * @return the new body, or NULL if the file did not contain one
+ */
+body_t *body_load(FILE *file);
+
 #endif // #ifndef __BODY_H__
@@ -0,0 +1,78 @@
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A recording of rendered frames, written out by a worker thread.
+ * Frames are filled in place in a fixed ring of buffers, so the caller never
+ * waits on the disk or an encoder: if every buffer is still waiting to be
+ * written, the frame is dropped instead.
+ *
+ * Frames are written as binary PPM (P6) images, which most image tools and
+ * encoders read directly (e.g. `ffmpeg -f image2pipe -c:v ppm -i -`).
+ */
+typedef struct capture capture_t;
+
+/**
+ * Starts a capture and its writer thread.
+ * The destination decides where frames go:
+ * - "|command" pipes every frame to the standard input of a shell command
+ * - a path containing '#' writes one file per frame, with the first run of
+ *   '#'s replaced by the zero-padded frame number (e.g. "out/frame_####.ppm")
+ * - any other path receives every frame, one after another
+ * Asserts that the destination can be opened.
+ *
+ * @param destination where to write the frames, as described above
+ * @param width the width of each frame in pixels
+ * @param height the height of each frame in pixels
+ * @param queue_length how many frames can wait to be written at once
+ * @return the new capture
+ */
+capture_t *capture_init(const char *destination, size_t width, size_t height,
+                        size_t queue_length);
+
+/**
+ * Writes every frame that is still queued, stops the writer thread,
+ * and releases the capture's memory.
+ *
+ * @param capture a pointer to a capture returned from capture_init()
+ */
+void capture_free(capture_t *capture);
+
+/**
+ * Gets the buffer to draw the next frame into.
+ * The frame is only written once it is passed to capture_submit().
+ *
+ * @param capture a pointer to a capture returned from capture_init()
+ * @return width * height RGB pixels, 3 bytes each, top row first,
+ *   or NULL if the queue is full and this frame must be dropped
+ */
+uint8_t *capture_next_frame(capture_t *capture);
+
+/**
+ * Queues the frame returned by the last capture_next_frame() call.
+ *
+ * @param capture a pointer to a capture returned from capture_init()
+ */
+void capture_submit(capture_t *capture);
+
+/**
+ * Gets the number of frames submitted so far.
+ *
+ * @param capture a pointer to a capture returned from capture_init()
+ * @return the number of frames queued with capture_submit()
+ */
+size_t capture_frames(capture_t *capture);
+
+/**
+ * Gets the number of frames dropped because the queue was full.
+ *
+ * @param capture a pointer to a capture returned from capture_init()
+ * @return the number of capture_next_frame() calls that returned NULL
+ */
+size_t capture_dropped(capture_t *capture);
+
+#endif // #ifndef __CAPTURE_H__
@@ -2,6 +2,7 @@
 #define __FORCES_H__
 
 #include "scene.h"
+#include <stdio.h>
 
 /**
  * Gets the list of bodies from the given aux
@@ -12,6 +13,37 @@
  */
 list_t *aux_get_bodies(void *auxil, free_func_t freer);
 
+/**
+ * Gets whether the given aux belongs to a collision whose bodies were touching
+ * the last time it was checked.
+ *
+ * @param aux a void pointer to the auxiliary variable
+ * @param freer function used to distinguish between different auxiliary structs
+ * @return true if aux is a collision aux and its bodies are in contact
+ */
+bool aux_get_contact(void *auxil, free_func_t freer);
+
+/**
+ * Gets whether the auxes freed by the given function belong to a collision
+ * force creator.
+ *
+ * @param freer function used to distinguish between different auxiliary structs
+ * @return true if the auxes are collision auxes
+ */
+bool aux_is_collision(free_func_t freer);
+
+/**
+ * Gets whether the force creator whose auxes are freed by the given function
+ * only computes forces from the current positions and velocities of its
+ * bodies, without side effects, so it can safely be re-evaluated several times
+ * in one tick. This holds for gravity, springs and drag, but not for
+ * collisions.
+ *
+ * @param freer function used to distinguish between different auxiliary structs
+ * @return whether the force creator can be resampled mid-tick
+ */
+bool aux_is_stateless(free_func_t freer);
+
 typedef struct force_applier force_applier_t;
 
 force_applier_t *force_applier_init(force_creator_t forcer, free_func_t freer);
@@ -24,11 +56,16 @@ force_creator_t force_applier_get_force_creator(force_applier_t *applier);
 
 free_func_t force_applier_get_freer(force_applier_t *applier);
 
-void force_applier_add_aux(force_applier_t *applier, void *aux);
+// takes ownership of bodies, which may be NULL
+void force_applier_add_aux(force_applier_t *applier, void *aux,
+                           list_t *bodies);
 
 void *force_applier_get_aux(force_applier_t *applier, size_t index);
 
-// remove and frees
+// the bodies the aux at index was added with
+list_t *force_applier_get_bodies(force_applier_t *applier, size_t index);
+
+// removes and frees the aux and its bodies list
 void force_applier_remove_aux(force_applier_t *applier, size_t index);
 
 /**
@@ -51,6 +88,89 @@ void handle_destructive_collision(bool last_tick_collision, body_t *body1,
  */
 void handle_physics_collision(bool last_tick_collision, body_t *body1,
                               body_t *body2, vector_t axis, void *aux);
+
+/**
+ * Writes the parameters and state of a force creator's or collision handler's
+ * auxiliary value, other than its bodies, for scene_save().
+ *
+ * @param aux the auxiliary value
+ * @param file the file to write to
+ * @return false if the value could not be written
+ */
+typedef bool (*aux_saver_t)(void *aux, FILE *file);
+
+/**
+ * Recreates an auxiliary value written by an aux_saver_t, for scene_load().
+ *
+ * @param file the file to read from
+ * @param bodies the bodies the force creator applied to, already restored;
+ *   the aux may keep the list, which belongs to the scene
+ * @param scene the scene being restored
+ * @param context the context passed to scene_load(), e.g. the game state
+ *   that collision handlers update
+ * @return the new auxiliary value, or NULL if it could not be read
+ */
+typedef void *(*aux_loader_t)(FILE *file, list_t *bodies, scene_t *scene,
+                              void *context);
+
+/**
+ * Registers a kind of force creator so scenes using it can be saved and
+ * loaded. Kinds are looked up by forcer when saving and by name when loading.
+ * Earth gravity, Newtonian gravity, springs, spring networks, drag and
+ * collisions are registered already.
+ *
+ * @param name a unique name for the kind, at most 255 characters,
+ *   which is written to the file
+ * @param forcer the force creator
+ * @param freer the function the scene frees the force creator's aux with
+ * @param saver writes an aux, or NULL if it has no state to write
+ * @param loader reads an aux written by saver, or NULL to use a NULL aux
+ */
+void register_force_kind(const char *name, force_creator_t forcer,
+                         free_func_t freer, aux_saver_t saver,
+                         aux_loader_t loader);
+
+/**
+ * Registers a collision handler so collisions using it can be saved and
+ * loaded. handle_destructive_collision() and handle_physics_collision()
+ * are registered already.
+ *
+ * @param name a unique name for the handler, at most 255 characters
+ * @param handler the collision handler
+ * @param freer the function the handler's aux is freed with, or NULL
+ * @param saver writes the handler's aux, or NULL if it has no state to write
+ * @param loader reads an aux written by saver, or NULL to use a NULL aux
+ */
+void register_collision_kind(const char *name, collision_handler_t handler,
+                             free_func_t freer, aux_saver_t saver,
+                             aux_loader_t loader);
+
+/**
+ * Writes the kind of a force creator and its aux (but not its bodies).
+ * Asserts that the force creator, and its collision handler if it has one,
+ * were registered with register_force_kind() or register_collision_kind().
+ *
+ * @param forcer the force creator
+ * @param aux the force creator's aux
+ * @param file the file to write to
+ * @return false if the force creator could not be written
+ */
+bool force_kind_save(force_creator_t forcer, void *aux, FILE *file);
+
+/**
+ * Reads a force creator written by force_kind_save() and adds it to a scene.
+ *
+ * @param file the file to read from
+ * @param scene the scene to add the force creator to
+ * @param bodies the force creator's bodies, which the scene takes ownership of
+ *   if it is loaded
+ * @param context passed to the kind's aux_loader_t
+ * @return false if the file did not contain a registered force creator,
+ *   or if the kind has no aux_loader_t but bodies is not NULL
+ */
+bool force_kind_load(FILE *file, scene_t *scene, list_t *bodies,
+                     void *context);
+
 /**
  * Adds a force creator to a scene that applies gravity the body and the floor.
  * The force creator will be called each tick
@@ -90,6 +210,47 @@ void create_newtonian_gravity(scene_t *scene, double G, list_t *bodies);
  */
 void create_spring(scene_t *scene, double k, list_t *bodies);
 
+/**
+ * A group of springs solved together with an implicit (backward Euler) method.
+ * Explicitly integrated springs blow up when k * dt^2 / mass gets large,
+ * so stiff ropes and cloths built from create_spring() need tiny ticks.
+ * A spring network stays stable at large dt by solving for the spring
+ * impulses at the end of the tick, iterating over all of its springs
+ * in a batch (Gauss-Seidel) using contiguous arrays.
+ */
+typedef struct spring_network spring_network_t;
+
+/**
+ * Adds an empty spring network to a scene.
+ * Springs are added to it afterwards with spring_network_add().
+ * The network is registered with every body it connects,
+ * so the whole network is removed if any one of its bodies is removed.
+ *
+ * @param scene the scene containing the bodies
+ * @param iterations the number of solver sweeps over all springs per tick;
+ *   more iterations make densely connected networks converge more closely
+ * @return the network, which is owned and freed by the scene
+ */
+spring_network_t *create_spring_network(scene_t *scene, size_t iterations);
+
+/**
+ * Adds a spring between two bodies to a spring network.
+ * Acts like create_spring(), but is integrated implicitly with the network.
+ *
+ * @param network a network returned from create_spring_network()
+ * @param k the Hooke's constant for the spring
+ * @param bodies the two bodies to connect. The list is freed by this function.
+ */
+void spring_network_add(spring_network_t *network, double k, list_t *bodies);
+
+/**
+ * Gets the number of springs in a spring network.
+ *
+ * @param network a network returned from create_spring_network()
+ * @return the number of springs added with spring_network_add()
+ */
+size_t spring_network_springs(spring_network_t *network);
+
 /**
  * Adds a force creator to a scene that applies a drag force on a body.
  * The force creator will be called each tick
@@ -135,6 +296,9 @@ void create_destructive_collision(scene_t *scene, list_t *bodies);
 // auxiliary init for physics collisions
 void *physics_collision_aux_init(double elasticity);
 
+// auxiliary freer for physics collisions
+void physics_collision_aux_free(void *aux);
+
 /**
  * Adds a force creator to a scene that applies impulses
  * to resolve collisions between two bodies in the scene.
@@ -0,0 +1,109 @@
+#ifndef __INTEGRATOR_H__
+#define __INTEGRATOR_H__
+
+#include "body.h"
+#include <stddef.h>
+
+/**
+ * The numerical schemes a scene can use to advance its bodies each tick.
+ * They trade accuracy for speed:
+ * - INTEGRATOR_AVERAGE_VELOCITY is body_tick(): the velocity is updated
+ *   explicitly and the body moves at the average of the old and new velocity.
+ * - INTEGRATOR_SEMI_IMPLICIT_EULER updates the velocity first and then moves
+ *   the body at the new velocity. Cheapest, symplectic, first order.
+ * - INTEGRATOR_VELOCITY_VERLET is second order and symplectic, so energy does
+ *   not drift in conservative systems even with large ticks.
+ * - INTEGRATOR_RK4 is fourth order but re-evaluates the force creators
+ *   four more times per tick, so it is by far the most expensive.
+ */
+typedef enum {
+  INTEGRATOR_AVERAGE_VELOCITY,
+  INTEGRATOR_SEMI_IMPLICIT_EULER,
+  INTEGRATOR_VELOCITY_VERLET,
+  INTEGRATOR_RK4
+} integrator_t;
+
+/**
+ * A function that recomputes the forces on bodies for the state they are
+ * currently in, used by integrators that sample forces mid-tick.
+ * Only forces (not impulses) added during the call are taken into account.
+ */
+typedef void (*force_evaluator_t)(void *aux);
+
+/**
+ * Scratch arrays for integrate_rk4(), with room for `capacity` bodies.
+ * Their owner (e.g. a scene) keeps them between ticks so they are only
+ * reallocated when the number of bodies grows. A zeroed workspace is empty.
+ */
+typedef struct rk4_workspace {
+  size_t capacity;
+  vector_t *start_position;
+  vector_t *start_velocity;
+  vector_t *first_acceleration;
+  vector_t *base_acceleration;
+  vector_t *stage_velocity;
+  vector_t *stage_acceleration;
+  vector_t *velocity_sum;
+  vector_t *acceleration_sum;
+} rk4_workspace_t;
+
+/**
+ * Releases the arrays in an RK4 workspace, leaving it empty.
+ *
+ * @param workspace the workspace to empty
+ */
+void rk4_workspace_free(rk4_workspace_t *workspace);
+
+/**
+ * Advances bodies with body_tick().
+ *
+ * @param bodies an array of the bodies to integrate
+ * @param count the number of bodies in the array
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void integrate_average_velocity(body_t **bodies, size_t count, double dt);
+
+/**
+ * Advances bodies with semi-implicit (symplectic) Euler.
+ * Uses and then resets the forces and impulses accumulated on the bodies.
+ *
+ * @param bodies an array of the bodies to integrate
+ * @param count the number of bodies in the array
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void integrate_semi_implicit_euler(body_t **bodies, size_t count, double dt);
+
+/**
+ * Advances bodies with velocity Verlet.
+ * The second half-kick of each tick uses the acceleration of the next tick,
+ * so the acceleration stored on each body by the previous tick is used
+ * to complete it; it is zero after body_set_velocity() or body_sleep().
+ * Uses and then resets the accumulated forces and impulses.
+ *
+ * @param bodies an array of the bodies to integrate
+ * @param count the number of bodies in the array
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void integrate_velocity_verlet(body_t **bodies, size_t count, double dt);
+
+/**
+ * Advances bodies with the classic fourth-order Runge-Kutta method.
+ * The forces already accumulated on the bodies are the first sample.
+ * The bodies are then moved to each intermediate state and evaluate() is
+ * called to resample the forces; the difference between those samples and
+ * the forces evaluate() gives at the starting state is added to the first
+ * sample, so forces evaluate() does not know about (e.g. collisions)
+ * are held constant over the tick.
+ *
+ * @param bodies an array of the bodies to integrate
+ * @param count the number of bodies in the array
+ * @param dt the number of seconds elapsed since the last tick
+ * @param evaluate a function adding the resampled forces to the bodies
+ * @param aux the auxiliary value to pass to evaluate
+ * @param workspace scratch arrays, grown to fit count bodies if needed
+ */
+void integrate_rk4(body_t **bodies, size_t count, double dt,
+                   force_evaluator_t evaluate, void *aux,
+                   rk4_workspace_t *workspace);
+
+#endif // #ifndef __INTEGRATOR_H__
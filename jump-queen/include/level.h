@@ -0,0 +1,95 @@
+#ifndef __LEVEL_H__
+#define __LEVEL_H__
+
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A level of platforms stored in a flat, versioned binary file.
+ * The file is a header, then an index of where each screen's platforms
+ * start, then every platform as a fixed-size record sorted by screen.
+ * It is mapped into memory as is, so opening a level costs the same
+ * however many screens it has, and a screen's platforms can be read
+ * without looking at any other screen.
+ *
+ * Distances are in window units: x in window widths from the left of the
+ * level and y in window heights from its bottom, so screen n spans
+ * n <= y < n + 1. The format is native-endian.
+ */
+typedef struct level level_t;
+
+/** The kinds of platform a level can contain */
+typedef enum {
+  LEVEL_STATIONARY,
+  LEVEL_MOVING_X,
+  LEVEL_MOVING_Y,
+  LEVEL_SLIPPERY,
+  LEVEL_DISAPPEARING
+} level_platform_type_t;
+
+/** One platform of a level, as stored in the file */
+typedef struct level_platform {
+  uint32_t type;
+  uint32_t screen;
+  vector_t bottom_left;
+  vector_t top_right;
+  // moving platforms only: the starting velocity, in window units per second,
+  // and the lowest and highest coordinate along the axis the platform moves
+  vector_t velocity;
+  vector_t bounds;
+} level_platform_t;
+
+/**
+ * Opens a level file by mapping it into memory.
+ *
+ * @param path the path of a file written by level_write()
+ * @return the level, or NULL if the file could not be read or is not a level
+ *   of the current version
+ */
+level_t *level_open(const char *path);
+
+/**
+ * Unmaps a level and releases its memory.
+ *
+ * @param level a pointer to a level returned from level_open()
+ */
+void level_close(level_t *level);
+
+/**
+ * Gets the number of screens in a level, including empty ones.
+ *
+ * @param level a pointer to a level returned from level_open()
+ * @return the number of screens
+ */
+size_t level_screens(level_t *level);
+
+/**
+ * Gets the platforms of one screen of a level. Asserts the screen exists.
+ * The platforms point into the mapped file and stay valid until the level
+ * is closed.
+ *
+ * @param level a pointer to a level returned from level_open()
+ * @param screen the index of the screen, starting at 0 for the bottom one
+ * @param count set to the number of platforms in the screen
+ * @return the screen's platforms
+ */
+const level_platform_t *level_screen_platforms(level_t *level, size_t screen,
+                                               size_t *count);
+
+/**
+ * Writes a level file.
+ * Asserts that the platforms are sorted by screen
+ * and that each is in one of the level's screens.
+ *
+ * @param path the file to write
+ * @param screens the number of screens in the level
+ * @param platforms every platform in the level
+ * @param count the number of platforms
+ * @return false if the file could not be written
+ */
+bool level_write(const char *path, size_t screens,
+                 const level_platform_t *platforms, size_t count);
+
+#endif // #ifndef __LEVEL_H__
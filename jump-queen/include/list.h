@@ -64,6 +64,27 @@ void *list_get(list_t *list, size_t index);
  */
 void *list_remove(list_t *list, size_t index);
 
+/**
+ * Replaces the element at a given index in a list and returns the old one.
+ * Asserts that the index is valid and that the new value is non-NULL.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param index an index in the list (the first element is at 0)
+ * @param value the new element at the given index
+ * @return the element previously at the given index
+ */
+void *list_set(list_t *list, size_t index, void *value);
+
+/**
+ * Shrinks a list to its first size elements.
+ * The dropped elements are NOT freed; the caller must already own them.
+ * Asserts that size is no larger than the list's current size.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param size the new size of the list
+ */
+void list_truncate(list_t *list, size_t size);
+
 /**
  * Appends an element to the end of a list.
  * If the list is filled to capacity, resizes the list to fit more elements
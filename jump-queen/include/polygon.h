@@ -73,6 +73,11 @@ void polygon_dilate_y(list_t *polygon, double factor);
  */
 void polygon_dilate(list_t *polygon, double factor);
 
+/*
+ * The constructors below allocate their vertices with vec_alloc(), so a vertex
+ * removed from one of their lists must be released with vec_free(), not free().
+ */
+
 /**
  * Makes a list_t * of vector_t's that assign the points for a
  * 'points'-sided shape with radius of size 'radius' with center
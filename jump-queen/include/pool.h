@@ -0,0 +1,66 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A free-list allocator for objects of a single size.
+ * Objects are carved out of large chunks and released objects are kept on a
+ * free list for reuse, so spawning and despawning the same kind of object
+ * over and over stops calling malloc() and free() once the pool has grown
+ * to the peak number of live objects. Chunks are only freed with the pool.
+ */
+typedef struct pool pool_t;
+
+/**
+ * Allocates memory for an empty pool.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param object_size the size in bytes of the objects handed out
+ * @param chunk_objects the number of objects to allocate space for at a time
+ * @return the new pool
+ */
+pool_t *pool_init(size_t object_size, size_t chunk_objects);
+
+/**
+ * Releases the memory allocated for a pool,
+ * including every object allocated from it.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ */
+void pool_free(pool_t *pool);
+
+/**
+ * Allocates an object from a pool, suitably aligned for any type.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return a pointer to an uninitialized object
+ */
+void *pool_alloc(pool_t *pool);
+
+/**
+ * Returns an object to a pool so it can be handed out again.
+ *
+ * @param pool the pool the object was allocated from
+ * @param object a pointer returned from pool_alloc(), or NULL to do nothing
+ */
+void pool_release(pool_t *pool, void *object);
+
+/**
+ * Gets the number of objects allocated from a pool and not yet released.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the number of live objects
+ */
+size_t pool_live(pool_t *pool);
+
+/**
+ * Gets the number of objects a pool has room for without growing.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the number of live and free objects
+ */
+size_t pool_capacity(pool_t *pool);
+
+#endif // #ifndef __POOL_H__
@@ -0,0 +1,134 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Timing probes around the phases of a frame.
+ * The engine's hot paths are wrapped in PROFILE_BEGIN()/PROFILE_END(),
+ * which only do anything when compiled with -DPROFILE
+ * (run 'make clean' then 'make PROFILE=true ...'), so they cost nothing
+ * otherwise. Each probe adds to its phase's call count and total time,
+ * and can also be kept as an event in a Chrome trace
+ * (open it at chrome://tracing or https://ui.perfetto.dev).
+ *
+ * The probes keep global state and must all run on one thread;
+ * with RENDER_THREAD that is the simulation thread.
+ */
+typedef enum {
+  PROFILE_TICK,      // all of scene_tick()
+  PROFILE_FORCES,    // running the force creators
+  PROFILE_REMOVAL,   // removing auxes and bodies marked for removal
+  PROFILE_INTEGRATE, // integrating and substepping the moving bodies
+  PROFILE_COLLISION, // apply_collision()
+  PROFILE_BODY_TICK, // body_tick()
+  PROFILE_RENDER,    // sdl_render_scene()
+  PROFILE_FRAME,     // from the end of one frame to the end of the next
+  PROFILE_PHASES     // the number of phases
+} profile_phase_t;
+
+/**
+ * The calls to one phase and the time spent in them.
+ */
+typedef struct {
+  size_t count;
+  uint64_t ns;
+} profile_stats_t;
+
+#ifdef PROFILE
+#define PROFILE_BEGIN(phase) uint64_t profile_start_##phase = profile_now()
+#define PROFILE_END(phase) profile_record(phase, profile_start_##phase)
+#define PROFILE_FRAME_END() profile_frame()
+#else
+#define PROFILE_BEGIN(phase) ((void)0)
+#define PROFILE_END(phase) ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+#endif
+
+/**
+ * Reads a monotonic clock.
+ *
+ * @return the time in nanoseconds since some fixed point
+ */
+uint64_t profile_now(void);
+
+/**
+ * Records one call to a phase, ending now.
+ * Usually called through PROFILE_END().
+ *
+ * @param phase the phase that was running
+ * @param start the profile_now() time when it started
+ */
+void profile_record(profile_phase_t phase, uint64_t start);
+
+/**
+ * Ends a frame: records a PROFILE_FRAME since the last one, and prints the
+ * frame's phases if profile_report_frames() was given a file.
+ * Usually called once per frame through PROFILE_FRAME_END().
+ * The first frame is timed from profile_reset(), which must come first.
+ */
+void profile_frame(void);
+
+/**
+ * Gets a phase's calls and time since the last profile_reset().
+ *
+ * @param phase the phase to look up
+ * @return its number of calls and total nanoseconds
+ */
+profile_stats_t profile_get(profile_phase_t phase);
+
+/**
+ * Gets a phase's name, as used in reports and traces.
+ *
+ * @param phase the phase to look up
+ * @return a short lowercase name, e.g. "forces"
+ */
+const char *profile_phase_name(profile_phase_t phase);
+
+/**
+ * Clears every phase's totals and any buffered trace events.
+ */
+void profile_reset(void);
+
+/**
+ * Prints every phase's calls, total and average time since the last reset.
+ *
+ * @param file where to print the report
+ */
+void profile_report(FILE *file);
+
+/**
+ * Prints one line per frame from now on, with each phase's calls and time
+ * during the frame.
+ *
+ * @param file where to print the lines, or NULL to stop printing them
+ */
+void profile_report_frames(FILE *file);
+
+/**
+ * Starts keeping every probe as a trace event, until a buffer of about
+ * a million events is full.
+ */
+void profile_trace_start(void);
+
+/**
+ * Writes the buffered events as Chrome trace JSON.
+ *
+ * @param file where to write the trace
+ * @return whether the whole trace was written
+ */
+bool profile_trace_write(FILE *file);
+
+/**
+ * Starts profiling as set by environment variables, and prints or writes
+ * the results when the program exits:
+ * - PROFILE_REPORT=1 prints a line per frame and a summary at exit
+ * - PROFILE_TRACE is a file to write a Chrome trace to at exit
+ * Called from sdl_init() in -DPROFILE builds.
+ */
+void profile_start(void);
+
+#endif // #ifndef __PROFILE_H__
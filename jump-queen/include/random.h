@@ -1,7 +1,141 @@
+#ifndef __RANDOM_H__
+#define __RANDOM_H__
+
 #include "color.h"
 #include <math.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+/**
+ * A xoshiro256** random number generator.
+ * Each generator is an independent stream, so code that runs on several
+ * threads should give each thread its own (see rng_split()) instead of
+ * sharing the global one behind the r_* functions.
+ * Generators are small enough to keep on the stack or inside other structs.
+ */
+typedef struct rng {
+  uint64_t state[4];
+} rng_t;
+
+/**
+ * @brief Seeds a generator. The same seed always gives the same numbers.
+ *
+ * @param rng the generator to seed
+ * @param seed any 64-bit value, including 0
+ */
+void rng_seed(rng_t *rng, uint64_t seed);
+
+/**
+ * @brief Returns 64 random bits and advances a generator
+ *
+ * @param rng a generator seeded with rng_seed()
+ * @return uint64_t the random bits
+ */
+uint64_t rng_next(rng_t *rng);
+
+/**
+ * @brief Advances a generator by 2^128 numbers, as if rng_next() had been
+ * called that many times. Used to start streams that never overlap.
+ *
+ * @param rng a generator seeded with rng_seed()
+ */
+void rng_jump(rng_t *rng);
+
+/**
+ * @brief Splits off an independent stream, e.g. for a worker thread.
+ * The new stream continues where the generator was, and the generator
+ * jumps 2^128 numbers ahead, so splitting repeatedly gives streams that
+ * never overlap and are the same every run for the same seed.
+ *
+ * @param rng a generator seeded with rng_seed()
+ * @return rng_t the new stream
+ */
+rng_t rng_split(rng_t *rng);
+
+/**
+ * @brief Returns a random sign from a generator
+ *
+ * @param rng a generator seeded with rng_seed()
+ * @return int the sign returned (1 or -1)
+ */
+int rng_sign(rng_t *rng);
+
+/**
+ * @brief returns a random int between min (inclusive) and max (inclusive)
+ *
+ * @param rng a generator seeded with rng_seed()
+ * @param min integer where random number gen starts
+ * @param max integer where random number gen ends
+ * @return int the random int returned [min, max]
+ */
+int rng_int(rng_t *rng, int min, int max);
+
+/**
+ * @brief returns a random double between min (inclusive) and max (exclusive)
+ *
+ * @param rng a generator seeded with rng_seed()
+ * @param min double where random number gen starts
+ * @param max double where random number gen ends
+ * @return double the random double returned [min, max)
+ */
+double rng_double(rng_t *rng, double min, double max);
+
+/**
+ * @brief returns a random color with all random rgb floats
+ *
+ * @param rng a generator seeded with rng_seed()
+ * @return rgb_color_t the random color returned
+ */
+rgb_color_t rng_color(rng_t *rng);
+
+/**
+ * @brief returns a random pastel color with all random rgb floats
+ *
+ * @param rng a generator seeded with rng_seed()
+ * @return rgb_color_t the random pastel color returned
+ */
+rgb_color_t rng_pastel_color(rng_t *rng);
+
+/**
+ * @brief Fills an array with random doubles in [min, max).
+ * Gives the same numbers as calling rng_double() count times.
+ *
+ * @param rng a generator seeded with rng_seed()
+ * @param values where to write the doubles
+ * @param count the number of doubles to write
+ * @param min double where random number gen starts
+ * @param max double where random number gen ends
+ */
+void rng_fill_doubles(rng_t *rng, double *values, size_t count, double min,
+                      double max);
+
+/**
+ * @brief Fills an array with random colors.
+ * Gives the same colors as calling rng_color() count times.
+ *
+ * @param rng a generator seeded with rng_seed()
+ * @param colors where to write the colors
+ * @param count the number of colors to write
+ */
+void rng_fill_colors(rng_t *rng, rgb_color_t *colors, size_t count);
+
+/**
+ * @brief Gets the global generator used by the r_* functions.
+ * Until r_seed() is called it is seeded with 0, like rand() before srand().
+ * Not thread-safe; give each thread its own stream with rng_split().
+ *
+ * @return rng_t* the global generator
+ */
+rng_t *r_global();
+
+/**
+ * @brief Seeds the global generator used by the r_* functions
+ *
+ * @param seed any 64-bit value, e.g. from sdl_random_seed()
+ */
+void r_seed(uint64_t seed);
+
 /**
  * @brief Returns a random sign
  *
@@ -19,11 +153,11 @@ int r_sign();
 int r_int(int min, int max);
 
 /**
- * @brief returns a random double between min (inclusive) and max (inclusive)
+ * @brief returns a random double between min (inclusive) and max (exclusive)
  *
  * @param min double where random number gen starts
  * @param max double where random number gen ends
- * @return double the random double returned [min, max]
+ * @return double the random double returned [min, max)
  */
 double r_double(double min, double max);
 
@@ -39,4 +173,24 @@ rgb_color_t r_color();
  *
  * @return rgb_color_t the random pastel color returned
  */
-rgb_color_t r_pastel_color();
\ No newline at end of file
+rgb_color_t r_pastel_color();
+
+/**
+ * @brief Fills an array with random doubles in [min, max)
+ *
+ * @param values where to write the doubles
+ * @param count the number of doubles to write
+ * @param min double where random number gen starts
+ * @param max double where random number gen ends
+ */
+void r_fill_doubles(double *values, size_t count, double min, double max);
+
+/**
+ * @brief Fills an array with random colors
+ *
+ * @param colors where to write the colors
+ * @param count the number of colors to write
+ */
+void r_fill_colors(rgb_color_t *colors, size_t count);
+
+#endif // #ifndef __RANDOM_H__
@@ -0,0 +1,109 @@
+#ifndef __RASTER_H__
+#define __RASTER_H__
+
+#include "vector.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * An in-memory framebuffer with a software polygon rasterizer.
+ * Used to render without a display, e.g. to benchmark the render path.
+ * Pixels are 0xAARRGGBB, stored row by row from the top of the image.
+ */
+typedef struct raster raster_t;
+
+/**
+ * Allocates a framebuffer. Its pixels start out uninitialized.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param width the width of the image in pixels
+ * @param height the height of the image in pixels
+ * @return the new framebuffer
+ */
+raster_t *raster_init(size_t width, size_t height);
+
+/**
+ * Releases the memory allocated for a framebuffer.
+ *
+ * @param raster a pointer to a framebuffer returned from raster_init()
+ */
+void raster_free(raster_t *raster);
+
+/**
+ * Gets the width of a framebuffer.
+ *
+ * @param raster a pointer to a framebuffer returned from raster_init()
+ * @return the width in pixels
+ */
+size_t raster_width(raster_t *raster);
+
+/**
+ * Gets the height of a framebuffer.
+ *
+ * @param raster a pointer to a framebuffer returned from raster_init()
+ * @return the height in pixels
+ */
+size_t raster_height(raster_t *raster);
+
+/**
+ * Gets the pixels of a framebuffer.
+ *
+ * @param raster a pointer to a framebuffer returned from raster_init()
+ * @return width * height pixels, the top row first
+ */
+uint32_t *raster_pixels(raster_t *raster);
+
+/**
+ * Sets a run of pixels to one color.
+ * Uses SSE2 stores when available, which is where filling spends its time.
+ *
+ * @param pixels the first pixel to set
+ * @param count the number of pixels to set
+ * @param color the color to set them to
+ */
+void raster_fill_span(uint32_t *pixels, size_t count, uint32_t color);
+
+/**
+ * Sets every pixel of a framebuffer to one color.
+ *
+ * @param raster a pointer to a framebuffer returned from raster_init()
+ * @param color the color to fill with
+ */
+void raster_clear(raster_t *raster, uint32_t color);
+
+/**
+ * Fills a polygon using the even-odd rule, one scanline at a time.
+ * A pixel is filled if its center is inside the polygon, so polygons that
+ * share an edge never both fill the pixels along it.
+ * Parts of the polygon outside the framebuffer are clipped.
+ *
+ * @param raster a pointer to a framebuffer returned from raster_init()
+ * @param points the polygon's vertices in pixel coordinates (y down)
+ * @param n the number of vertices
+ * @param color the color to fill with
+ */
+void raster_fill_polygon(raster_t *raster, const vector_t *points, size_t n,
+                         uint32_t color);
+
+/**
+ * Draws the one pixel wide outline of a rectangle, clipped to the framebuffer.
+ *
+ * @param raster a pointer to a framebuffer returned from raster_init()
+ * @param x the column of the rectangle's left edge
+ * @param y the row of the rectangle's top edge
+ * @param width the width of the rectangle
+ * @param height the height of the rectangle
+ * @param color the color to draw with
+ */
+void raster_outline_rect(raster_t *raster, long x, long y, long width,
+                         long height, uint32_t color);
+
+/**
+ * Copies a framebuffer's pixels out as 3-byte RGB triples, top row first.
+ *
+ * @param raster a pointer to a framebuffer returned from raster_init()
+ * @param rgb where to write width * height * 3 bytes
+ */
+void raster_read_rgb(raster_t *raster, uint8_t *rgb);
+
+#endif // #ifndef __RASTER_H__
@@ -0,0 +1,107 @@
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include "sdl_wrapper.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * A log of everything that makes a run of a demo differ from another:
+ * the random seed, the dt of every tick and every key event.
+ * Replaying the log feeds the same inputs back in the same order,
+ * so the run is repeated exactly, without waiting on the clock.
+ *
+ * The log is the seed followed by records in the order they happened:
+ * one per tick (9 bytes) and one per key event (11 bytes).
+ */
+typedef struct replay replay_t;
+
+/** The kinds of record in a log, as returned by replay_next() */
+typedef enum { REPLAY_END, REPLAY_TICK, REPLAY_KEY } replay_record_t;
+
+/**
+ * Starts recording a log. Asserts that the file can be opened.
+ *
+ * @param path the file to write the log to
+ * @param seed the random seed the run uses
+ * @return the new log, which records until replay_close() is called
+ */
+replay_t *replay_record(const char *path, uint64_t seed);
+
+/**
+ * Reads a whole log into memory to play it back.
+ *
+ * @param path a file written by a log from replay_record()
+ * @return the log, or NULL if the file could not be read or is not a log
+ */
+replay_t *replay_play(const char *path);
+
+/**
+ * Finishes writing a recorded log, and releases the log's memory.
+ *
+ * @param replay a pointer to a log returned from replay_record()
+ *   or replay_play()
+ */
+void replay_close(replay_t *replay);
+
+/**
+ * Gets the random seed of a log.
+ *
+ * @param replay a pointer to a log returned from replay_record()
+ *   or replay_play()
+ * @return the seed
+ */
+uint64_t replay_seed(replay_t *replay);
+
+/**
+ * Appends the dt of a tick to a recorded log.
+ *
+ * @param replay a pointer to a log returned from replay_record()
+ * @param dt the time the tick advanced the demo by
+ */
+void replay_write_tick(replay_t *replay, double dt);
+
+/**
+ * Appends a key event to a recorded log.
+ *
+ * @param replay a pointer to a log returned from replay_record()
+ * @param event the key event
+ */
+void replay_write_key(replay_t *replay, key_event_t event);
+
+/**
+ * Gets the kind of the next record of a log being played back.
+ * A truncated last record counts as the end of the log.
+ *
+ * @param replay a pointer to a log returned from replay_play()
+ * @return the kind of the next record, or REPLAY_END if there are none left
+ */
+replay_record_t replay_next(replay_t *replay);
+
+/**
+ * Reads the next record of a log being played back, which must be a tick.
+ *
+ * @param replay a pointer to a log returned from replay_play()
+ * @return the tick's dt
+ */
+double replay_read_tick(replay_t *replay);
+
+/**
+ * Reads the next record of a log being played back,
+ * which must be a key event.
+ *
+ * @param replay a pointer to a log returned from replay_play()
+ * @return the key event
+ */
+key_event_t replay_read_key(replay_t *replay);
+
+/**
+ * Gets the number of ticks recorded or played back so far.
+ *
+ * @param replay a pointer to a log returned from replay_record()
+ *   or replay_play()
+ * @return the number of ticks
+ */
+size_t replay_ticks(replay_t *replay);
+
+#endif // #ifndef __REPLAY_H__
@@ -2,7 +2,9 @@
 #define __SCENE_H__
 
 #include "body.h"
+#include "integrator.h"
 #include "list.h"
+#include <stdio.h>
 
 /**
  * A collection of bodies and force creators.
@@ -58,8 +60,40 @@ body_t *scene_get_body(scene_t *scene, size_t index);
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param body a pointer to the body to add to the scene
+ * @return a handle to the body, also available from body_get_handle()
  */
-void scene_add_body(scene_t *scene, body_t *body);
+body_handle_t scene_add_body(scene_t *scene, body_t *body);
+
+/**
+ * Looks up the body a handle refers to in O(1).
+ * Prefer holding handles over raw body pointers outside the scene:
+ * a pointer dangles once its body is freed, a handle just stops resolving.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handle a handle returned from scene_add_body()
+ * @return the body, or NULL if it has been removed from the scene
+ */
+body_t *scene_resolve(scene_t *scene, body_handle_t handle);
+
+/**
+ * Gets whether a handle still refers to a body in the scene
+ * that has not been removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handle a body handle
+ * @return true if scene_resolve() would return a body
+ */
+bool scene_handle_valid(scene_t *scene, body_handle_t handle);
+
+/**
+ * Marks the body a handle refers to for removal, like body_remove().
+ * The handle becomes invalid immediately and the body is freed during the
+ * next scene_tick(). Does nothing if the handle is already invalid.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handle a body handle
+ */
+void scene_remove_handle(scene_t *scene, body_handle_t handle);
 
 /**
  * @deprecated Use body_remove() instead
@@ -92,12 +126,64 @@ void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
  * @param bodies the list of bodies affected by the force creator.
  *   The force creator will be removed if any of these bodies are removed.
  *   This list does not own the bodies, so its freer should be NULL.
+ *   The scene takes ownership of the list and frees it along with aux.
  * @param freer if non-NULL, a function to call in order to free aux
  */
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer);
 
+/**
+ * Enables sleeping for the bodies in a scene.
+ * A body whose speed stays below velocity_threshold for time_to_sleep seconds
+ * is put to sleep, along with every body it is (transitively) touching,
+ * once all of them have come to rest. Sleeping bodies are not integrated,
+ * and force creators whose bodies are all asleep or immovable are skipped,
+ * so bodies at rest cost almost nothing. Touching an awake body, or having
+ * a force, impulse or velocity applied, wakes a body and its whole island.
+ * Sleeping is disabled by default.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param velocity_threshold the speed below which a body counts as resting
+ * @param time_to_sleep how long a body must rest before sleeping, in seconds;
+ *   if not positive, sleeping is disabled and all bodies are woken up
+ */
+void scene_set_sleep(scene_t *scene, double velocity_threshold,
+                     double time_to_sleep);
+
+/**
+ * Chooses the numerical scheme used to advance the scene's bodies each tick.
+ * Defaults to INTEGRATOR_AVERAGE_VELOCITY, i.e. body_tick().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param integrator the integrator to use from the next tick onwards
+ */
+void scene_set_integrator(scene_t *scene, integrator_t integrator);
+
+/**
+ * Lets fast bodies take several smaller steps per tick instead of making
+ * every body in the scene pay for a smaller dt.
+ * A body takes enough substeps (up to max_substeps) that it never moves more
+ * than half its bounding radius in one, with its forces held constant.
+ * Collisions involving a substepping body are rechecked between substeps.
+ * Disabled (the default) when max_substeps <= 1.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param max_substeps the most substeps a body can take in one tick
+ */
+void scene_set_substepping(scene_t *scene, size_t max_substeps);
+
+/**
+ * Gets the time interval of the tick the scene is executing,
+ * i.e. the dt passed to the most recent call to scene_tick().
+ * Useful for force creators that need to know the step size,
+ * such as the implicit spring network.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the time elapsed over the current tick, in seconds
+ */
+double scene_get_dt(scene_t *scene);
+
 /**
  * Executes a tick of a given scene over a small time interval.
  * This requires executing all the force creators
@@ -110,4 +196,52 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
  */
 void scene_tick(scene_t *scene, double dt);
 
+/**
+ * How scene_save() and scene_load() write and read the info of bodies.
+ */
+typedef struct info_codec {
+  /**
+   * Writes a body's info. Called for every body, so must accept NULL info.
+   * @return false if the info could not be written
+   */
+  bool (*save)(void *info, FILE *file);
+  /**
+   * Reads info written by save into *info.
+   * context is the value passed to scene_load().
+   * @return false if the info could not be read
+   */
+  bool (*load)(FILE *file, void *context, void **info);
+  /** The info_freer given to the loaded bodies */
+  free_func_t freer;
+} info_codec_t;
+
+/**
+ * Writes a snapshot of a scene to a binary file: its settings, its bodies
+ * and their handles, and its force creators along with the bodies they apply
+ * to. Force creators are written through the kinds registered in forces.h,
+ * and asserts that every force creator's kind is registered.
+ * The format is native-endian and only meant to be read on the same platform,
+ * e.g. to restore a checkpoint.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param file the file to write to, opened in binary mode
+ * @param codec writes the bodies' info, or NULL to not save it
+ * @return false if the scene could not be written
+ */
+bool scene_save(scene_t *scene, FILE *file, const info_codec_t *codec);
+
+/**
+ * Restores a scene written by scene_save().
+ * Handles to its bodies from before it was saved refer to the same bodies
+ * in the restored scene.
+ *
+ * @param file the file to read from, opened in binary mode
+ * @param codec reads the bodies' info; must match the codec used to save
+ *   the scene, or be NULL if that was NULL
+ * @param context passed to codec->load and to the force creators' loaders
+ * @return the restored scene, or NULL if the file did not contain a valid
+ *   snapshot
+ */
+scene_t *scene_load(FILE *file, const info_codec_t *codec, void *context);
+
 #endif // #ifndef __SCENE_H__
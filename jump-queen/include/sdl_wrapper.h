@@ -6,6 +6,7 @@
 #include "scene.h"
 #include "vector.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 extern const int WINDOW_WIDTH;
 extern const int WINDOW_HEIGHT;
@@ -53,10 +54,36 @@ typedef enum { KEY_PRESSED, KEY_RELEASED } key_event_type_t;
 typedef void (*key_handler_t)(char key, key_event_type_t type, double held_time,
                               void *state);
 
+/**
+ * A key event, with the same values that are passed to a key handler.
+ */
+typedef struct {
+  char key;
+  key_event_type_t type;
+  double held_time;
+} key_event_t;
+
 /**
  * Initializes the SDL window and renderer.
  * Must be called once before any of the other SDL functions.
  *
+ * Runs can be recorded and run without a display through the environment:
+ * - HEADLESS (any value) renders in software to a hidden window
+ * - CAPTURE is a destination for every frame shown, as in capture_init();
+ *   while capturing, time_since_last_tick() always returns one 60 FPS frame
+ * - CAPTURE_FRAMES makes sdl_is_done() return true after that many frames
+ * - RENDERER=software draws with the in-memory rasterizer in raster.h
+ *   instead of SDL, without opening a window (ignored with RENDER_THREAD)
+ * - REPLAY_RECORD is a file to log the run's seed, dts and key events to
+ * - REPLAY is a log to play back instead of reading the keyboard and clock;
+ *   sdl_is_done() returns true once the log runs out
+ * - PROFILE_REPORT and PROFILE_TRACE print or save timings of each phase
+ *   of a frame in -DPROFILE builds (see profile_start())
+ *
+ * For example, `HEADLESS=1 CAPTURE=out/frame_####.ppm CAPTURE_FRAMES=600`,
+ * or `RENDERER=software REPLAY=run.log` to repeat a recorded run
+ * as fast as possible.
+ *
  * @param min the x and y coordinates of the bottom left of the scene
  * @param max the x and y coordinates of the top right of the scene
  */
@@ -91,13 +118,56 @@ void sdl_show(void);
 
 /**
  * Draws all bodies in a scene.
- * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
+ * This internally calls sdl_clear() and sdl_show(),
  * so those functions should not be called directly.
+ * With SDL 2.0.18 or newer, every body is triangulated into one vertex buffer
+ * and drawn with a single SDL_RenderGeometry() call; older versions fall back
+ * to sdl_draw_polygon() for each body.
+ * Bodies whose bounding circle lies entirely outside the window are skipped.
+ *
+ * Immovable bodies (see body_is_immovable()) are drawn into a cached texture
+ * that is only redrawn when body_static_version() changes (e.g. one of them
+ * moves, turns, resizes, changes color, or is added or removed), or when the
+ * camera or window size changes. Checking the cache costs the same however
+ * many there are. They always appear beneath the bodies that move.
+ *
+ * When compiled with RENDER_THREAD, this instead copies the scene into a
+ * snapshot for the render thread and returns without waiting for it.
  *
  * @param scene the scene to draw
  */
 void sdl_render_scene(scene_t *scene);
 
+#ifdef RENDER_THREAD
+/**
+ * Polls SDL events and draws the most recent snapshot published by
+ * sdl_render_scene(). Must be called repeatedly from the thread that called
+ * sdl_init(), while the simulation (including sdl_is_done()) runs on another.
+ * Key events are passed to the key handler by the next sdl_is_done() call.
+ *
+ * @return false once the window has been closed or sdl_is_done() has
+ *   returned true, true otherwise
+ */
+bool sdl_render_frame(void);
+#endif
+
+/**
+ * Moves the camera, shifting which part of the scene is drawn.
+ * The scene point at min + offset (with min and max given to sdl_init())
+ * is drawn where min would be with no offset. Scene coordinates are
+ * unaffected, so scrolling through a large scene costs nothing per body.
+ *
+ * @param offset the camera's displacement from its initial position
+ */
+void sdl_set_camera(vector_t offset);
+
+/**
+ * Gets the camera's current displacement, as set with sdl_set_camera().
+ *
+ * @return the camera offset (initially the zero vector)
+ */
+vector_t sdl_get_camera(void);
+
 /**
  * Registers a function to be called every time a key is pressed.
  * Overwrites any existing handler.
@@ -126,12 +196,44 @@ void sdl_render_scene(scene_t *scene);
  */
 void sdl_on_key(key_handler_t handler);
 
+/**
+ * Gets whether a key is currently held down,
+ * as of the last call to sdl_is_done().
+ * Takes constant time, so demos can poll the keys they care about each tick.
+ *
+ * @param key a 7-bit character or one of the special values listed above
+ * @return whether the key has been pressed and not yet released
+ */
+bool sdl_key_down(char key);
+
+/**
+ * Gets every key event collected by the last call to sdl_is_done(),
+ * oldest first, so a demo can handle its input in one place each tick.
+ * The events remain valid until sdl_is_done() is called again.
+ * Events are collected whether or not a key handler is registered.
+ *
+ * @param count where to store the number of events
+ * @return the array of events
+ */
+const key_event_t *sdl_key_events(size_t *count);
+
 /**
  * Gets the amount of time that has passed since the last time
  * this function was called, in seconds.
+ * While a log is played back, returns the recorded times instead.
  *
  * @return the number of seconds that have elapsed
  */
 double time_since_last_tick(void);
 
+/**
+ * Gets the seed a demo should seed its random numbers with,
+ * so that recorded runs can be played back exactly (see sdl_init()).
+ * This is the seed of the log being played back if there is one,
+ * and otherwise the time the demo started. May be called before sdl_init().
+ *
+ * @return the seed
+ */
+uint64_t sdl_random_seed(void);
+
 #endif // #ifndef __SDL_WRAPPER_H__
@@ -18,6 +18,26 @@ typedef struct {
  */
 extern const vector_t VEC_ZERO;
 
+/**
+ * Allocates a vector on the heap, e.g. to add it to a polygon.
+ * Vectors are pooled, so they must be released with vec_free(), not free().
+ * This includes the vertices of polygons made by the library (e.g. by
+ * make_rectangle() or body_get_shape()), even once removed from their list.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @param v the value of the new vector
+ * @return a pointer to the new vector
+ */
+vector_t *vec_alloc(vector_t v);
+
+/**
+ * Releases a vector allocated with vec_alloc().
+ * Usable as the freer of a list of vectors.
+ *
+ * @param v a pointer returned from vec_alloc()
+ */
+void vec_free(void *v);
+
 /**
  * Checks if two vectors are equal.
  *
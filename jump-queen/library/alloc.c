@@ -0,0 +1,123 @@
+#include "alloc.h"
+#include <assert.h>
+#include <stdlib.h>
+
+const char *const ALLOC_TAG_NAMES[] = {"other", "list",  "pool", "arena",
+                                       "body",  "force", "scene"};
+
+/**
+ * Kept in front of every allocation, so engine_free() knows how much
+ * memory it releases. Padded so the memory after it stays aligned.
+ */
+typedef union alloc_header {
+  struct {
+    size_t size;
+    alloc_tag_t tag;
+  } block;
+  max_align_t align;
+} alloc_header_t;
+
+alloc_stats_t alloc_stats[ALLOC_TAGS];
+size_t total_live_bytes = 0, total_peak_bytes = 0;
+
+/** Counts memory becoming live */
+void alloc_count(alloc_tag_t tag, size_t size) {
+  alloc_stats_t *stats = &alloc_stats[tag];
+  stats->allocations++;
+  stats->bytes += size;
+  stats->live_bytes += size;
+  if (stats->live_bytes > stats->peak_bytes) {
+    stats->peak_bytes = stats->live_bytes;
+  }
+  total_live_bytes += size;
+  if (total_live_bytes > total_peak_bytes) {
+    total_peak_bytes = total_live_bytes;
+  }
+}
+
+/** Counts memory being released */
+void alloc_uncount(alloc_header_t *header) {
+  alloc_stats_t *stats = &alloc_stats[header->block.tag];
+  stats->frees++;
+  stats->live_bytes -= header->block.size;
+  total_live_bytes -= header->block.size;
+}
+
+void *engine_malloc(size_t size, alloc_tag_t tag) {
+  assert(tag < ALLOC_TAGS);
+  alloc_header_t *header = malloc(sizeof(alloc_header_t) + size);
+  assert(header != NULL);
+  header->block.size = size;
+  header->block.tag = tag;
+  alloc_count(tag, size);
+  return header + 1;
+}
+
+void *engine_realloc(void *memory, size_t size, alloc_tag_t tag) {
+  if (memory == NULL) {
+    return engine_malloc(size, tag);
+  }
+  assert(tag < ALLOC_TAGS);
+  alloc_header_t *header = (alloc_header_t *)memory - 1;
+  alloc_uncount(header);
+  // a move is one allocation and one free, even if realloc() grew in place
+  header = realloc(header, sizeof(alloc_header_t) + size);
+  assert(header != NULL);
+  header->block.size = size;
+  header->block.tag = tag;
+  alloc_count(tag, size);
+  return header + 1;
+}
+
+void engine_free(void *memory) {
+  if (memory == NULL) {
+    return;
+  }
+  alloc_header_t *header = (alloc_header_t *)memory - 1;
+  alloc_uncount(header);
+  free(header);
+}
+
+alloc_stats_t alloc_get_stats(alloc_tag_t tag) {
+  assert(tag < ALLOC_TAGS);
+  return alloc_stats[tag];
+}
+
+alloc_stats_t alloc_total_stats(void) {
+  alloc_stats_t total = {.live_bytes = total_live_bytes,
+                         .peak_bytes = total_peak_bytes};
+  for (size_t i = 0; i < ALLOC_TAGS; i++) {
+    total.allocations += alloc_stats[i].allocations;
+    total.frees += alloc_stats[i].frees;
+    total.bytes += alloc_stats[i].bytes;
+  }
+  return total;
+}
+
+void alloc_reset_stats(void) {
+  for (size_t i = 0; i < ALLOC_TAGS; i++) {
+    alloc_stats_t *stats = &alloc_stats[i];
+    stats->allocations = stats->frees = stats->bytes = 0;
+    stats->peak_bytes = stats->live_bytes;
+  }
+  total_peak_bytes = total_live_bytes;
+}
+
+const char *alloc_tag_name(alloc_tag_t tag) {
+  assert(tag < ALLOC_TAGS);
+  return ALLOC_TAG_NAMES[tag];
+}
+
+void alloc_report(FILE *file) {
+  fprintf(file, "%-10s %10s %10s %12s %12s %12s\n", "tag", "allocs", "frees",
+          "bytes", "live bytes", "peak bytes");
+  for (size_t i = 0; i < ALLOC_TAGS; i++) {
+    alloc_stats_t stats = alloc_stats[i];
+    if (stats.allocations == 0 && stats.frees == 0 && stats.live_bytes == 0) {
+      continue;
+    }
+    fprintf(file, "%-10s %10zu %10zu %12zu %12zu %12zu\n", ALLOC_TAG_NAMES[i],
+            stats.allocations, stats.frees, stats.bytes, stats.live_bytes,
+            stats.peak_bytes);
+  }
+}
@@ -0,0 +1,100 @@
+#include "arena.h"
+#include "alloc.h"
+#include <assert.h>
+#include <stdlib.h>
+
+const size_t ARENA_ALIGNMENT = _Alignof(max_align_t);
+const size_t FRAME_ARENA_CAPACITY = 1 << 16;
+
+typedef struct arena_block {
+  struct arena_block *previous;
+  size_t capacity;
+  // the arena's offset at which this block starts
+  size_t start;
+  max_align_t data[];
+} arena_block_t;
+
+typedef struct arena {
+  arena_block_t *block;
+  size_t used;
+} arena_t;
+
+arena_t *frame = NULL;
+
+arena_block_t *arena_block_init(arena_block_t *previous, size_t capacity,
+                                size_t start) {
+  arena_block_t *block =
+      engine_malloc(sizeof(arena_block_t) + capacity, ALLOC_ARENA);
+  assert(block != NULL);
+  block->previous = previous;
+  block->capacity = capacity;
+  block->start = start;
+  return block;
+}
+
+arena_t *arena_init(size_t capacity) {
+  arena_t *arena = engine_malloc(sizeof(arena_t), ALLOC_ARENA);
+  assert(arena != NULL);
+  arena->block = arena_block_init(NULL, capacity, 0);
+  arena->used = 0;
+  return arena;
+}
+
+void arena_free_blocks(arena_block_t *block) {
+  while (block != NULL) {
+    arena_block_t *previous = block->previous;
+    engine_free(block);
+    block = previous;
+  }
+}
+
+void arena_free(arena_t *arena) {
+  arena_free_blocks(arena->block);
+  engine_free(arena);
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+  size = (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+  arena_block_t *block = arena->block;
+  if (arena->used + size > block->start + block->capacity) {
+    // chains on a block big enough for everything so far, so the block
+    // replacing the chain on reset will fit a repeat of this frame
+    size_t capacity = 2 * (block->start + block->capacity);
+    if (capacity < 2 * size) {
+      capacity = 2 * size;
+    }
+    block = arena_block_init(block, capacity, arena->used);
+    arena->block = block;
+  }
+  void *memory = (char *)block->data + (arena->used - block->start);
+  arena->used += size;
+  return memory;
+}
+
+void arena_reset(arena_t *arena) {
+  arena_block_t *block = arena->block;
+  if (block->previous != NULL) {
+    size_t capacity = block->start + block->capacity;
+    arena_free_blocks(block);
+    arena->block = arena_block_init(NULL, capacity, 0);
+  }
+  arena->used = 0;
+}
+
+arena_mark_t arena_mark(arena_t *arena) { return arena->used; }
+
+void arena_rewind(arena_t *arena, arena_mark_t mark) {
+  assert(mark <= arena->used);
+  // memory before the newest block is not reused until the next reset,
+  // which keeps allocations contiguous within a block
+  arena->used = mark > arena->block->start ? mark : arena->block->start;
+}
+
+size_t arena_used(arena_t *arena) { return arena->used; }
+
+arena_t *frame_arena(void) {
+  if (frame == NULL) {
+    frame = arena_init(FRAME_ARENA_CAPACITY);
+  }
+  return frame;
+}
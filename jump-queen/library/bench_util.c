@@ -0,0 +1,96 @@
+#include "bench_util.h"
+#include "profile.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t DEFAULT_BENCH_SAMPLES = 50;
+const uint64_t DEFAULT_BENCH_SAMPLE_NS = 100000;
+const size_t MAX_BENCH_ITERATIONS = (size_t)1 << 30;
+
+/** Written by bench_use() so its argument has to be computed */
+volatile double bench_sink;
+
+void bench_use(double value) { bench_sink = value; }
+
+/** Reads a positive number from an environment variable */
+size_t bench_setting(const char *variable, size_t fallback) {
+  const char *value = getenv(variable);
+  if (value == NULL || value[0] == '\0') {
+    return fallback;
+  }
+  long long setting = atoll(value);
+  return setting > 0 ? (size_t)setting : fallback;
+}
+
+int bench_compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/** Gets a percentile of sorted samples, by the nearest-rank method */
+double bench_percentile(const double *sorted, size_t count, double percent) {
+  size_t rank = (size_t)(percent / 100 * count + 0.999999);
+  if (rank < 1) {
+    rank = 1;
+  }
+  if (rank > count) {
+    rank = count;
+  }
+  return sorted[rank - 1];
+}
+
+bool bench_selected(const char *name) {
+  const char *filter = getenv("BENCH_FILTER");
+  return filter == NULL || strstr(name, filter) != NULL;
+}
+
+void bench_run(const char *name, bench_op_t op, void *state) {
+  if (!bench_selected(name)) {
+    return;
+  }
+  size_t sample_count = bench_setting("BENCH_SAMPLES", DEFAULT_BENCH_SAMPLES);
+  uint64_t sample_ns =
+      bench_setting("BENCH_SAMPLE_NS", DEFAULT_BENCH_SAMPLE_NS);
+
+  size_t iterations = 1;
+  while (true) {
+    uint64_t start = profile_now();
+    op(state, iterations);
+    if (profile_now() - start >= sample_ns ||
+        iterations >= MAX_BENCH_ITERATIONS) {
+      break;
+    }
+    iterations *= 2;
+  }
+
+  double *samples = malloc(sample_count * sizeof(double));
+  double *sorted = malloc(sample_count * sizeof(double));
+  assert(samples != NULL && sorted != NULL);
+  double total = 0;
+  for (size_t i = 0; i < sample_count; i++) {
+    uint64_t start = profile_now();
+    op(state, iterations);
+    samples[i] = (double)(profile_now() - start) / iterations;
+    total += samples[i];
+  }
+  memcpy(sorted, samples, sample_count * sizeof(double));
+  qsort(sorted, sample_count, sizeof(double), bench_compare_doubles);
+
+  printf("{\"name\": \"%s\", \"iterations\": %zu, \"median\": %.3f, "
+         "\"p90\": %.3f, \"p99\": %.3f, \"min\": %.3f, \"mean\": %.3f, "
+         "\"samples\": [",
+         name, iterations, bench_percentile(sorted, sample_count, 50),
+         bench_percentile(sorted, sample_count, 90),
+         bench_percentile(sorted, sample_count, 99), sorted[0],
+         total / sample_count);
+  for (size_t i = 0; i < sample_count; i++) {
+    printf(i == 0 ? "%.3f" : ", %.3f", samples[i]);
+  }
+  printf("]}\n");
+  fflush(stdout);
+  free(samples);
+  free(sorted);
+}
@@ -1,15 +1,48 @@
 #include "body.h"
+#include "alloc.h"
 #include "list.h"
 #include "polygon.h"
+#include "pool.h"
+#include "profile.h"
 #include "vector.h"
+#include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
+
+// angular speed (radians per second) below which a body counts as resting
+const double ANGULAR_REST_THRESHOLD = M_PI / 90;
+const body_handle_t BODY_HANDLE_NULL = {0, 0};
+const size_t BODY_POOL_CHUNK = 128;
+// the most vertices room is made for before a loaded body's shape is read
+const size_t BODY_LOAD_VERTICES = 64;
+
+// the fixed-size part of a body as written by body_save()
+typedef struct body_record {
+  double mass;
+  rgb_color_t color;
+  vector_t center;
+  double rotation;
+  double angular_velocity;
+  vector_t velocity;
+  vector_t acceleration;
+  vector_t force;
+  vector_t impulse;
+  double rest_time;
+  body_handle_t handle;
+  uint32_t vertices;
+  bool is_removed;
+  bool removable;
+  bool sleeping;
+  bool sleepable;
+} body_record_t;
 
 typedef struct body {
   double mass;
   list_t *shape;
   rgb_color_t color;
   vector_t center;
+  double radius;
   double rotation;
   double angular_velocity;
   vector_t velocity;
@@ -20,22 +53,57 @@ typedef struct body {
   free_func_t info_freer;
   bool is_removed;
   bool removable;
+  bool sleeping;
+  bool sleepable;
+  double rest_time;
+  size_t island;
+  body_handle_t handle;
 } body_t;
 
+pool_t *body_pool = NULL;
+// counts changes to how immovable bodies look (see body_static_version())
+size_t immovable_version = 0;
+
+size_t body_static_version(void) { return immovable_version; }
+
+void body_mark_static_changed(body_t *body) {
+  if (body_is_immovable(body)) {
+    immovable_version++;
+  }
+}
+
+// notes a change of velocity that made the body start or stop being immovable
+void body_check_immovability(body_t *body, bool was_immovable) {
+  if (body_is_immovable(body) != was_immovable) {
+    immovable_version++;
+  }
+}
+
 body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
-  body_t *body = malloc(sizeof(body_t));
+  if (body_pool == NULL) {
+    body_pool = pool_init(sizeof(body_t), BODY_POOL_CHUNK);
+  }
+  body_t *body = pool_alloc(body_pool);
   body->shape = shape;
   body->mass = mass;
   body->color = color;
   body->center = polygon_centroid(body->shape);
+  body_update_radius(body);
   body->rotation = 0.0;
   body->angular_velocity = 0.0;
   body->velocity = VEC_ZERO;
   body->acceleration = VEC_ZERO;
   body->force = VEC_ZERO;
   body->impulse = VEC_ZERO;
+  body->info = NULL;
+  body->info_freer = NULL;
   body->is_removed = false;
   body->removable = true;
+  body->sleeping = false;
+  body->sleepable = true;
+  body->rest_time = 0.0;
+  body->island = 0;
+  body->handle = BODY_HANDLE_NULL;
   return body;
 }
 
@@ -48,22 +116,29 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
 }
 
 void body_free(body_t *body) {
+  body_mark_static_changed(body);
   if (body->info_freer != NULL) {
     body->info_freer(body->info);
   }
   list_free(body->shape);
-  free(body);
+  pool_release(body_pool, body);
 }
 
 void *body_get_info(body_t *body) { return body->info; }
 
+void body_set_info(body_t *body, void *info, free_func_t info_freer) {
+  if (body->info_freer != NULL) {
+    body->info_freer(body->info);
+  }
+  body->info = info;
+  body->info_freer = info_freer;
+}
+
 list_t *body_get_shape(body_t *body) {
   size_t size = list_size(body->shape);
-  list_t *lst = list_init(size, free);
+  list_t *lst = list_init(size, vec_free);
   for (size_t i = 0; i < size; i++) {
-    vector_t *temp = malloc(sizeof(vector_t));
-    *temp = *(vector_t *)list_get(body->shape, i);
-    list_add(lst, temp);
+    list_add(lst, vec_alloc(*(vector_t *)list_get(body->shape, i)));
   }
   return lst;
 }
@@ -76,6 +151,18 @@ rgb_color_t body_get_color(body_t *body) { return body->color; }
 
 vector_t body_get_centroid(body_t *body) { return body->center; }
 
+double body_get_radius(body_t *body) { return body->radius; }
+
+void body_update_radius(body_t *body) {
+  double radius_squared = 0.0;
+  for (size_t i = 0; i < list_size(body->shape); i++) {
+    vector_t offset =
+        vec_subtract(*(vector_t *)list_get(body->shape, i), body->center);
+    radius_squared = fmax(radius_squared, vec_dot(offset, offset));
+  }
+  body->radius = sqrt(radius_squared);
+}
+
 double body_get_rotation(body_t *body) { return body->rotation; }
 
 double body_get_angular_velocity(body_t *body) {
@@ -86,54 +173,97 @@ vector_t body_get_velocity(body_t *body) { return body->velocity; }
 
 vector_t body_get_acceleration(body_t *body) { return body->acceleration; }
 
-void body_set_color(body_t *body, rgb_color_t color) { body->color = color; }
+vector_t body_get_force(body_t *body) { return body->force; }
+
+vector_t body_get_impulse(body_t *body) { return body->impulse; }
+
+void body_set_color(body_t *body, rgb_color_t color) {
+  if (color.r != body->color.r || color.g != body->color.g ||
+      color.b != body->color.b) {
+    body_mark_static_changed(body);
+  }
+  body->color = color;
+}
 
 void body_translate(body_t *body, vector_t translation) {
+  if (translation.x != 0 || translation.y != 0) {
+    body_mark_static_changed(body);
+  }
   polygon_translate(body->shape, translation);
   body->center = vec_add(body->center, translation);
 }
 
 void body_set_centroid(body_t *body, vector_t x) {
+  // integrators set the centroid of every body, moved or not
+  if (x.x != body->center.x || x.y != body->center.y) {
+    body_mark_static_changed(body);
+  }
   polygon_translate(body->shape, vec_subtract(x, body->center));
   body->center = x;
 }
 
 void body_set_rotation(body_t *body, double angle) {
+  if (angle != body->rotation) {
+    body_mark_static_changed(body);
+  }
   polygon_rotate(body->shape, body->rotation - angle, body->center);
   body->rotation = angle;
 }
 
 void body_set_angular_velocity(body_t *body, double velocity) {
+  bool was_immovable = body_is_immovable(body);
+  body_wake(body);
   body->angular_velocity = velocity;
+  body_check_immovability(body, was_immovable);
 }
 
-void body_set_velocity(body_t *body, vector_t v) { body->velocity = v; }
+void body_set_velocity(body_t *body, vector_t v) {
+  bool was_immovable = body_is_immovable(body);
+  body_wake(body);
+  body->velocity = v;
+  body->acceleration = VEC_ZERO;
+  body_check_immovability(body, was_immovable);
+}
 
 void body_set_acceleration(body_t *body, vector_t v) { body->acceleration = v; }
 
 void body_dilate_x(body_t *body, double factor) {
+  if (factor != 1) {
+    body_mark_static_changed(body);
+  }
   polygon_dilate_x(body->shape, factor);
   vector_t new_center = polygon_centroid(body->shape);
   polygon_translate(body->shape, vec_subtract(body->center, new_center));
+  body_update_radius(body);
 }
 
 void body_dilate_y(body_t *body, double factor) {
+  if (factor != 1) {
+    body_mark_static_changed(body);
+  }
   polygon_dilate_y(body->shape, factor);
   vector_t new_center = polygon_centroid(body->shape);
   polygon_translate(body->shape, vec_subtract(body->center, new_center));
+  body_update_radius(body);
 }
 
 void body_dilate(body_t *body, double factor) {
+  if (factor != 1) {
+    body_mark_static_changed(body);
+  }
   polygon_dilate(body->shape, factor);
   vector_t new_center = polygon_centroid(body->shape);
   polygon_translate(body->shape, vec_subtract(body->center, new_center));
+  body_update_radius(body);
 }
 
 void body_add_force(body_t *body, vector_t force) {
+  body_wake(body);
   body->force = vec_add(body->force, force);
 }
 
 void body_add_impulse(body_t *body, vector_t impulse) {
+  body_wake(body);
   body->impulse = vec_add(body->impulse, impulse);
 }
 
@@ -143,6 +273,7 @@ void body_reset_force_and_impulse(body_t *body) {
 }
 
 void body_tick(body_t *body, double dt) {
+  PROFILE_BEGIN(PROFILE_BODY_TICK);
   if (body->mass != INFINITY && body->mass != 0) {
     vector_t velocity_change_from_force =
         vec_multiply(dt / body->mass, body->force);
@@ -164,6 +295,7 @@ void body_tick(body_t *body, double dt) {
   body_set_rotation(body, body->rotation + (body->angular_velocity * dt));
   body->force = VEC_ZERO;
   body->impulse = VEC_ZERO;
+  PROFILE_END(PROFILE_BODY_TICK);
 }
 
 void body_remove(body_t *body) { body->is_removed = true; }
@@ -174,4 +306,146 @@ bool body_is_removable(body_t *body) { return body->removable; }
 
 void body_set_removability(body_t *body, bool removable) {
   body->removable = removable;
-}
\ No newline at end of file
+}
+
+bool body_is_immovable(body_t *body) {
+  return (body->mass == INFINITY || body->mass == 0) &&
+         body->velocity.x == 0 && body->velocity.y == 0 &&
+         body->angular_velocity == 0;
+}
+
+bool body_is_sleeping(body_t *body) { return body->sleeping; }
+
+void body_sleep(body_t *body) {
+  if (!body->sleepable) {
+    return;
+  }
+  bool was_immovable = body_is_immovable(body);
+  body->sleeping = true;
+  body->velocity = VEC_ZERO;
+  body->acceleration = VEC_ZERO;
+  body->angular_velocity = 0.0;
+  body->force = VEC_ZERO;
+  body->impulse = VEC_ZERO;
+  body_check_immovability(body, was_immovable);
+}
+
+void body_wake(body_t *body) {
+  if (body->sleeping) {
+    body->sleeping = false;
+    body->rest_time = 0.0;
+    body->acceleration = VEC_ZERO;
+  }
+}
+
+bool body_can_sleep(body_t *body) { return body->sleepable; }
+
+void body_set_sleepability(body_t *body, bool sleepable) {
+  body->sleepable = sleepable;
+  if (!sleepable) {
+    body_wake(body);
+  }
+}
+
+double body_update_rest_time(body_t *body, double dt, double threshold) {
+  if (vec_dot(body->velocity, body->velocity) < threshold * threshold &&
+      fabs(body->angular_velocity) < ANGULAR_REST_THRESHOLD) {
+    body->rest_time += dt;
+  } else {
+    body->rest_time = 0.0;
+  }
+  return body->rest_time;
+}
+
+bool body_is_resting(body_t *body, double threshold) {
+  vector_t velocity = body->velocity;
+  if (body->mass != INFINITY && body->mass != 0) {
+    velocity = vec_add(velocity, vec_multiply(1 / body->mass, body->impulse));
+  }
+  return vec_dot(velocity, velocity) < threshold * threshold &&
+         fabs(body->angular_velocity) < ANGULAR_REST_THRESHOLD;
+}
+
+double body_get_rest_time(body_t *body) { return body->rest_time; }
+
+size_t body_get_island(body_t *body) { return body->island; }
+
+void body_set_island(body_t *body, size_t island) { body->island = island; }
+
+body_handle_t body_get_handle(body_t *body) { return body->handle; }
+
+void body_set_handle(body_t *body, body_handle_t handle) {
+  body->handle = handle;
+}
+
+bool body_handle_equal(body_handle_t a, body_handle_t b) {
+  return a.index == b.index && a.generation == b.generation;
+}
+
+bool body_save(body_t *body, FILE *file) {
+  size_t vertices = list_size(body->shape);
+  // zeroed so the padding after the color is not left uninitialized
+  body_record_t record;
+  memset(&record, 0, sizeof(record));
+  record.mass = body->mass;
+  record.color = body->color;
+  record.center = body->center;
+  record.rotation = body->rotation;
+  record.angular_velocity = body->angular_velocity;
+  record.velocity = body->velocity;
+  record.acceleration = body->acceleration;
+  record.force = body->force;
+  record.impulse = body->impulse;
+  record.rest_time = body->rest_time;
+  record.handle = body->handle;
+  record.vertices = vertices;
+  record.is_removed = body->is_removed;
+  record.removable = body->removable;
+  record.sleeping = body->sleeping;
+  record.sleepable = body->sleepable;
+  vector_t *points = engine_malloc(vertices * sizeof(vector_t), ALLOC_BODY);
+  assert(points != NULL);
+  for (size_t i = 0; i < vertices; i++) {
+    points[i] = *(vector_t *)list_get(body->shape, i);
+  }
+  bool written = fwrite(&record, sizeof(record), 1, file) == 1 &&
+                 fwrite(points, sizeof(vector_t), vertices, file) == vertices;
+  engine_free(points);
+  return written;
+}
+
+body_t *body_load(FILE *file) {
+  body_record_t record;
+  if (fread(&record, sizeof(record), 1, file) != 1 || record.vertices == 0) {
+    return NULL;
+  }
+  // the shape grows as the vertices are read, so a corrupt count runs into
+  // the end of the file instead of an enormous allocation
+  size_t capacity = record.vertices < BODY_LOAD_VERTICES ? record.vertices
+                                                         : BODY_LOAD_VERTICES;
+  list_t *shape = list_init(capacity, vec_free);
+  for (size_t i = 0; i < record.vertices; i++) {
+    vector_t point;
+    if (fread(&point, sizeof(vector_t), 1, file) != 1) {
+      list_free(shape);
+      return NULL;
+    }
+    list_add(shape, vec_alloc(point));
+  }
+  body_t *body = body_init(shape, record.mass, record.color);
+  body->center = record.center;
+  body_update_radius(body);
+  body->rotation = record.rotation;
+  body->angular_velocity = record.angular_velocity;
+  body->velocity = record.velocity;
+  body->acceleration = record.acceleration;
+  body->force = record.force;
+  body->impulse = record.impulse;
+  body->rest_time = record.rest_time;
+  body->handle = record.handle;
+  body->is_removed = record.is_removed;
+  body->removable = record.removable;
+  body->sleeping = record.sleeping;
+  body->sleepable = record.sleepable;
+  return body;
+}
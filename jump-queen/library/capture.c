@@ -0,0 +1,166 @@
+#include "capture.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char CAPTURE_PIPE_PREFIX = '|';
+const char CAPTURE_NUMBER_MARK = '#';
+const size_t CAPTURE_BYTES_PER_PIXEL = 3;
+const size_t CAPTURE_PATH_LENGTH = 4096;
+
+typedef struct capture {
+  size_t width;
+  size_t height;
+  size_t frame_size;
+  // A ring of queue_length frames, of which queued frames starting at head
+  // are waiting to be written.
+  uint8_t *frames;
+  size_t queue_length;
+  size_t head;
+  size_t queued;
+  size_t submitted;
+  size_t dropped;
+  bool stopping;
+  pthread_mutex_t lock;
+  pthread_cond_t frame_ready;
+  pthread_t writer;
+  // Exactly one of these is set: a pipe, a single file, or a file pattern
+  FILE *pipe;
+  FILE *file;
+  char *pattern;
+  size_t written;
+} capture_t;
+
+/** Opens the file for the given frame number of a "frame_####" pattern */
+FILE *open_frame_file(capture_t *capture, size_t frame) {
+  char path[CAPTURE_PATH_LENGTH];
+  const char *start = strchr(capture->pattern, CAPTURE_NUMBER_MARK);
+  size_t prefix = start - capture->pattern;
+  size_t digits = strspn(start, (char[]){CAPTURE_NUMBER_MARK, '\0'});
+  int length = snprintf(path, sizeof(path), "%.*s%0*zu%s", (int)prefix,
+                        capture->pattern, (int)digits, frame,
+                        start + digits);
+  assert(length >= 0 && (size_t)length < sizeof(path));
+  FILE *file = fopen(path, "wb");
+  assert(file != NULL);
+  return file;
+}
+
+/** Writes one frame as a PPM image */
+void write_frame(capture_t *capture, const uint8_t *pixels) {
+  FILE *out = capture->pattern != NULL
+                  ? open_frame_file(capture, capture->written)
+                  : capture->pipe != NULL ? capture->pipe : capture->file;
+  fprintf(out, "P6\n%zu %zu\n255\n", capture->width, capture->height);
+  fwrite(pixels, 1, capture->frame_size, out);
+  if (capture->pattern != NULL) {
+    fclose(out);
+  }
+  capture->written++;
+}
+
+/** The writer thread: writes queued frames in order until stopped */
+void *capture_run(void *arg) {
+  capture_t *capture = arg;
+  pthread_mutex_lock(&capture->lock);
+  while (true) {
+    while (capture->queued == 0 && !capture->stopping) {
+      pthread_cond_wait(&capture->frame_ready, &capture->lock);
+    }
+    if (capture->queued == 0) {
+      break;
+    }
+    uint8_t *frame = capture->frames + capture->head * capture->frame_size;
+    // the producer never touches queued frames, so write without the lock
+    pthread_mutex_unlock(&capture->lock);
+    write_frame(capture, frame);
+    pthread_mutex_lock(&capture->lock);
+    capture->head = (capture->head + 1) % capture->queue_length;
+    capture->queued--;
+  }
+  pthread_mutex_unlock(&capture->lock);
+  return NULL;
+}
+
+capture_t *capture_init(const char *destination, size_t width, size_t height,
+                        size_t queue_length) {
+  assert(width > 0 && height > 0);
+  assert(queue_length > 0);
+  capture_t *capture = malloc(sizeof(capture_t));
+  assert(capture != NULL);
+  capture->width = width;
+  capture->height = height;
+  capture->frame_size = width * height * CAPTURE_BYTES_PER_PIXEL;
+  capture->frames = malloc(queue_length * capture->frame_size);
+  assert(capture->frames != NULL);
+  capture->queue_length = queue_length;
+  capture->head = 0;
+  capture->queued = 0;
+  capture->submitted = 0;
+  capture->dropped = 0;
+  capture->stopping = false;
+  capture->written = 0;
+  capture->pipe = NULL;
+  capture->file = NULL;
+  capture->pattern = NULL;
+  if (destination[0] == CAPTURE_PIPE_PREFIX) {
+    capture->pipe = popen(destination + 1, "w");
+    assert(capture->pipe != NULL);
+  } else if (strchr(destination, CAPTURE_NUMBER_MARK) != NULL) {
+    capture->pattern = strdup(destination);
+    assert(capture->pattern != NULL);
+  } else {
+    capture->file = fopen(destination, "wb");
+    assert(capture->file != NULL);
+  }
+  pthread_mutex_init(&capture->lock, NULL);
+  pthread_cond_init(&capture->frame_ready, NULL);
+  int error = pthread_create(&capture->writer, NULL, capture_run, capture);
+  assert(error == 0);
+  return capture;
+}
+
+void capture_free(capture_t *capture) {
+  pthread_mutex_lock(&capture->lock);
+  capture->stopping = true;
+  pthread_cond_signal(&capture->frame_ready);
+  pthread_mutex_unlock(&capture->lock);
+  pthread_join(capture->writer, NULL);
+  if (capture->pipe != NULL) {
+    pclose(capture->pipe);
+  }
+  if (capture->file != NULL) {
+    fclose(capture->file);
+  }
+  free(capture->pattern);
+  pthread_cond_destroy(&capture->frame_ready);
+  pthread_mutex_destroy(&capture->lock);
+  free(capture->frames);
+  free(capture);
+}
+
+uint8_t *capture_next_frame(capture_t *capture) {
+  pthread_mutex_lock(&capture->lock);
+  bool full = capture->queued == capture->queue_length;
+  size_t tail = (capture->head + capture->queued) % capture->queue_length;
+  if (full) {
+    capture->dropped++;
+  }
+  pthread_mutex_unlock(&capture->lock);
+  return full ? NULL : capture->frames + tail * capture->frame_size;
+}
+
+void capture_submit(capture_t *capture) {
+  pthread_mutex_lock(&capture->lock);
+  assert(capture->queued < capture->queue_length);
+  capture->queued++;
+  capture->submitted++;
+  pthread_cond_signal(&capture->frame_ready);
+  pthread_mutex_unlock(&capture->lock);
+}
+
+size_t capture_frames(capture_t *capture) { return capture->submitted; }
+
+size_t capture_dropped(capture_t *capture) { return capture->dropped; }
@@ -1,4 +1,5 @@
 #include "math.h"
+#include "profile.h"
 #include "sdl_wrapper.h"
 #include "state.h"
 #include <stdio.h>
@@ -6,6 +7,9 @@
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
 #endif
+#ifdef RENDER_THREAD
+#include <pthread.h>
+#endif
 
 state_t *state;
 
@@ -16,6 +20,7 @@ void loop() {
   }
 
   emscripten_main(state);
+  PROFILE_FRAME_END();
 
   if (sdl_is_done(state)) { // Once our demo exits...
     emscripten_free(state); // Free any state variables we've been using
@@ -29,6 +34,28 @@ void loop() {
   }
 }
 
+#if defined(RENDER_THREAD) && !defined(__EMSCRIPTEN__)
+/** Runs the demo's simulation until sdl_is_done() stops it */
+void *simulate(void *unused) {
+  while (!sdl_is_done(state)) {
+    emscripten_main(state);
+    PROFILE_FRAME_END();
+  }
+  return NULL;
+}
+
+int main() {
+  state = emscripten_init();
+  pthread_t simulation;
+  pthread_create(&simulation, NULL, simulate, NULL);
+  // SDL only allows drawing from the thread that created the window
+  while (sdl_render_frame()) {
+    ;
+  }
+  pthread_join(simulation, NULL);
+  emscripten_free(state);
+}
+#else
 int main() {
 #ifdef __EMSCRIPTEN__
   // Set loop as the function emscripten calls to request a new frame
@@ -39,3 +66,4 @@ int main() {
   }
 #endif
 }
+#endif
@@ -1,10 +1,30 @@
 #include "forces.h"
+#include "alloc.h"
 #include "collision.h"
+#include "pool.h"
+#include "profile.h"
+#include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 const double BLOW_UP_DISTANCE = 5; // 5 for tests | 8 for preference
 const size_t INITIAL_AUXES_SIZE = 10;
+const size_t INITIAL_NETWORK_SPRINGS = 16;
+const size_t AUX_POOL_CHUNK = 256;
+
+// the aux records are pooled since collisions are created and destroyed
+// in bulk whenever bodies spawn and despawn
+pool_t *auxiliary_pool = NULL;
+pool_t *physics_collision_aux_pool = NULL;
+pool_t *auxiliary_collision_pool = NULL;
+
+void *aux_pool_alloc(pool_t **pool, size_t size) {
+  if (*pool == NULL) {
+    *pool = pool_init(size, AUX_POOL_CHUNK);
+  }
+  return pool_alloc(*pool);
+}
 
 typedef struct auxiliary {
   double constant;
@@ -12,7 +32,7 @@ typedef struct auxiliary {
 } auxiliary_t;
 
 auxiliary_t *auxiliary_init(double constant, list_t *bodies) {
-  auxiliary_t *aux = malloc(sizeof(auxiliary_t));
+  auxiliary_t *aux = aux_pool_alloc(&auxiliary_pool, sizeof(auxiliary_t));
   aux->constant = constant;
   aux->bodies = bodies;
   return aux;
@@ -20,21 +40,24 @@ auxiliary_t *auxiliary_init(double constant, list_t *bodies) {
 
 double aux_get_constant(auxiliary_t *aux) { return aux->constant; }
 
-void auxiliary_free(auxiliary_t *aux) {
-  list_free(aux->bodies);
-  free(aux);
-}
+// the bodies list belongs to the scene (see scene_add_bodies_force_creator())
+void auxiliary_free(auxiliary_t *aux) { pool_release(auxiliary_pool, aux); }
 
 typedef struct collision_aux {
   double elasticity;
 } physics_collision_aux_t;
 
 void *physics_collision_aux_init(double elasticity) {
-  physics_collision_aux_t *aux = malloc(sizeof(physics_collision_aux_t));
+  physics_collision_aux_t *aux = aux_pool_alloc(
+      &physics_collision_aux_pool, sizeof(physics_collision_aux_t));
   aux->elasticity = elasticity;
   return aux;
 }
 
+void physics_collision_aux_free(void *aux) {
+  pool_release(physics_collision_aux_pool, aux);
+}
+
 typedef struct auxiliary_collision {
   void *aux;
   list_t *bodies;
@@ -47,7 +70,8 @@ auxiliary_collision_t *auxiliary_collision_init(auxiliary_t *aux,
                                                 list_t *bodies,
                                                 collision_handler_t handler,
                                                 free_func_t freer) {
-  auxiliary_collision_t *aux_collision = malloc(sizeof(auxiliary_collision_t));
+  auxiliary_collision_t *aux_collision = aux_pool_alloc(
+      &auxiliary_collision_pool, sizeof(auxiliary_collision_t));
   aux_collision->aux = aux;
   aux_collision->bodies = bodies;
   aux_collision->handler = handler;
@@ -60,7 +84,36 @@ void auxiliary_collision_free(auxiliary_collision_t *aux_collision) {
   if (aux_collision->freer != NULL) {
     aux_collision->freer(aux_collision->aux);
   }
-  free(aux_collision);
+  pool_release(auxiliary_collision_pool, aux_collision);
+}
+
+typedef struct spring_network {
+  scene_t *scene;
+  list_t *bodies;
+  size_t iterations;
+  // springs, stored as parallel arrays indexing into bodies
+  size_t springs;
+  size_t spring_capacity;
+  size_t *first;
+  size_t *second;
+  double *k;
+  vector_t *impulse;
+  // per-body scratch space filled in at the start of each solve
+  size_t body_capacity;
+  vector_t *position;
+  vector_t *velocity;
+  double *inverse_mass;
+} spring_network_t;
+
+void spring_network_free(spring_network_t *network) {
+  engine_free(network->first);
+  engine_free(network->second);
+  engine_free(network->k);
+  engine_free(network->impulse);
+  engine_free(network->position);
+  engine_free(network->velocity);
+  engine_free(network->inverse_mass);
+  engine_free(network);
 }
 
 list_t *aux_get_bodies(void *auxil, free_func_t freer) {
@@ -70,26 +123,61 @@ list_t *aux_get_bodies(void *auxil, free_func_t freer) {
   if (freer == (free_func_t)auxiliary_free) {
     return ((auxiliary_t *)auxil)->bodies;
   }
+  if (freer == (free_func_t)spring_network_free) {
+    return ((spring_network_t *)auxil)->bodies;
+  }
   return ((auxiliary_collision_t *)auxil)->bodies;
 }
 
+bool aux_get_contact(void *auxil, free_func_t freer) {
+  if (freer != (free_func_t)auxiliary_collision_free) {
+    return false;
+  }
+  return ((auxiliary_collision_t *)auxil)->last_tick_collision;
+}
+
+bool aux_is_collision(free_func_t freer) {
+  return freer == (free_func_t)auxiliary_collision_free;
+}
+
+bool aux_is_stateless(free_func_t freer) {
+  return freer == (free_func_t)auxiliary_free;
+}
+
 typedef struct force_applier {
   force_creator_t forcer;
   list_t *auxes;
+  // the bodies each aux was added with (or NULL), in the same order as auxes;
+  // the lists belong to the applier
+  list_t **bodies;
+  size_t bodies_capacity;
   free_func_t freer;
 } force_applier_t;
 
 force_applier_t *force_applier_init(force_creator_t forcer, free_func_t freer) {
-  force_applier_t *applier = malloc(sizeof(force_applier_t));
+  force_applier_t *applier =
+      engine_malloc(sizeof(force_applier_t), ALLOC_FORCE);
   applier->forcer = forcer;
   applier->auxes = list_init(INITIAL_AUXES_SIZE, freer);
+  applier->bodies = NULL;
+  applier->bodies_capacity = 0;
   applier->freer = freer;
   return applier;
 }
 
+void force_bodies_free(list_t *bodies) {
+  if (bodies != NULL) {
+    list_free(bodies);
+  }
+}
+
 void force_applier_free(force_applier_t *applier) {
+  for (size_t i = 0; i < list_size(applier->auxes); i++) {
+    force_bodies_free(applier->bodies[i]);
+  }
   list_free(applier->auxes);
-  free(applier);
+  engine_free(applier->bodies);
+  engine_free(applier);
 }
 
 size_t force_applier_auxes(force_applier_t *applier) {
@@ -104,16 +192,38 @@ free_func_t force_applier_get_freer(force_applier_t *applier) {
   return applier->freer;
 }
 
-void force_applier_add_aux(force_applier_t *applier, void *aux) {
+void force_applier_add_aux(force_applier_t *applier, void *aux,
+                           list_t *bodies) {
+  size_t count = list_size(applier->auxes);
+  if (count == applier->bodies_capacity) {
+    applier->bodies_capacity =
+        count == 0 ? INITIAL_AUXES_SIZE : 2 * applier->bodies_capacity;
+    applier->bodies = engine_realloc(
+        applier->bodies, applier->bodies_capacity * sizeof(list_t *),
+        ALLOC_FORCE);
+    assert(applier->bodies != NULL);
+  }
   list_add(applier->auxes, aux);
+  applier->bodies[count] = bodies;
 }
 
 void *force_applier_get_aux(force_applier_t *applier, size_t index) {
   return list_get(applier->auxes, index);
 }
 
+list_t *force_applier_get_bodies(force_applier_t *applier, size_t index) {
+  assert(index < list_size(applier->auxes));
+  return applier->bodies[index];
+}
+
 void force_applier_remove_aux(force_applier_t *applier, size_t index) {
-  applier->freer(list_remove(applier->auxes, index));
+  void *aux = list_remove(applier->auxes, index);
+  if (applier->freer != NULL) {
+    applier->freer(aux);
+  }
+  force_bodies_free(applier->bodies[index]);
+  memmove(applier->bodies + index, applier->bodies + index + 1,
+          (list_size(applier->auxes) - index) * sizeof(list_t *));
 }
 
 void apply_earth_gravity(void *aux) {
@@ -174,6 +284,169 @@ void create_spring(scene_t *scene, double k, list_t *bodies) {
                                  bodies, (free_func_t)auxiliary_free);
 }
 
+// returns the index of body in the network, adding it if it is not there yet
+size_t spring_network_body_index(spring_network_t *network, body_t *body) {
+  size_t size = list_size(network->bodies);
+  for (size_t i = 0; i < size; i++) {
+    if (list_get(network->bodies, i) == body) {
+      return i;
+    }
+  }
+  list_add(network->bodies, body);
+  return size;
+}
+
+void spring_network_reserve_bodies(spring_network_t *network, size_t count) {
+  if (count <= network->body_capacity) {
+    return;
+  }
+  size_t capacity = network->body_capacity * 2;
+  if (capacity < count) {
+    capacity = count;
+  }
+  network->position = engine_realloc(
+      network->position, capacity * sizeof(*network->position), ALLOC_FORCE);
+  network->velocity = engine_realloc(
+      network->velocity, capacity * sizeof(*network->velocity), ALLOC_FORCE);
+  network->inverse_mass = engine_realloc(
+      network->inverse_mass, capacity * sizeof(*network->inverse_mass),
+      ALLOC_FORCE);
+  assert(network->position != NULL && network->velocity != NULL &&
+         network->inverse_mass != NULL);
+  network->body_capacity = capacity;
+}
+
+void apply_spring_network(void *aux) {
+  spring_network_t *network = (spring_network_t *)aux;
+  double dt = scene_get_dt(network->scene);
+  if (dt <= 0 || network->springs == 0) {
+    return;
+  }
+  // gather the bodies' state into contiguous arrays
+  size_t body_count = list_size(network->bodies);
+  spring_network_reserve_bodies(network, body_count);
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = (body_t *)list_get(network->bodies, i);
+    double mass = body_get_mass(body);
+    network->position[i] = body_get_centroid(body);
+    network->velocity[i] = body_get_velocity(body);
+    network->inverse_mass[i] = (mass == INFINITY || mass == 0) ? 0 : 1 / mass;
+  }
+  for (size_t s = 0; s < network->springs; s++) {
+    network->impulse[s] = VEC_ZERO;
+  }
+
+  // Gauss-Seidel sweeps solving P = dt * k * d for every spring's impulse P,
+  // where d is the spring's displacement at the end of the tick
+  // (so d itself depends on the impulses applied to the bodies)
+  for (size_t iteration = 0; iteration < network->iterations; iteration++) {
+    for (size_t s = 0; s < network->springs; s++) {
+      size_t a = network->first[s];
+      size_t b = network->second[s];
+      double w_a = network->inverse_mass[a];
+      double w_b = network->inverse_mass[b];
+      double k = network->k[s];
+      vector_t end_a = vec_add(network->position[a],
+                               vec_multiply(dt, network->velocity[a]));
+      vector_t end_b = vec_add(network->position[b],
+                               vec_multiply(dt, network->velocity[b]));
+      vector_t residual = vec_subtract(
+          vec_multiply(dt * k, vec_subtract(end_b, end_a)),
+          network->impulse[s]);
+      vector_t correction =
+          vec_multiply(1 / (1 + dt * dt * k * (w_a + w_b)), residual);
+      network->impulse[s] = vec_add(network->impulse[s], correction);
+      network->velocity[a] =
+          vec_add(network->velocity[a], vec_multiply(w_a, correction));
+      network->velocity[b] =
+          vec_subtract(network->velocity[b], vec_multiply(w_b, correction));
+    }
+  }
+
+  // scatter the solved velocity changes back as impulses
+  for (size_t i = 0; i < body_count; i++) {
+    if (network->inverse_mass[i] == 0) {
+      continue;
+    }
+    body_t *body = (body_t *)list_get(network->bodies, i);
+    vector_t change =
+        vec_subtract(network->velocity[i], body_get_velocity(body));
+    body_add_impulse(body, vec_multiply(body_get_mass(body), change));
+  }
+}
+
+spring_network_t *spring_network_init(scene_t *scene, size_t iterations,
+                                      list_t *bodies) {
+  assert(iterations > 0);
+  spring_network_t *network =
+      engine_malloc(sizeof(spring_network_t), ALLOC_FORCE);
+  assert(network != NULL);
+  network->scene = scene;
+  network->bodies = bodies;
+  network->iterations = iterations;
+  network->springs = 0;
+  network->spring_capacity = 0;
+  network->first = NULL;
+  network->second = NULL;
+  network->k = NULL;
+  network->impulse = NULL;
+  network->body_capacity = 0;
+  network->position = NULL;
+  network->velocity = NULL;
+  network->inverse_mass = NULL;
+  return network;
+}
+
+spring_network_t *create_spring_network(scene_t *scene, size_t iterations) {
+  spring_network_t *network = spring_network_init(
+      scene, iterations, list_init(2 * INITIAL_NETWORK_SPRINGS, NULL));
+  scene_add_bodies_force_creator(scene, apply_spring_network, network,
+                                 network->bodies,
+                                 (free_func_t)spring_network_free);
+  return network;
+}
+
+void spring_network_reserve_springs(spring_network_t *network, size_t count) {
+  if (count <= network->spring_capacity) {
+    return;
+  }
+  size_t capacity = network->spring_capacity == 0
+                        ? INITIAL_NETWORK_SPRINGS
+                        : 2 * network->spring_capacity;
+  if (capacity < count) {
+    capacity = count;
+  }
+  network->first =
+      engine_realloc(network->first, capacity * sizeof(size_t), ALLOC_FORCE);
+  network->second =
+      engine_realloc(network->second, capacity * sizeof(size_t), ALLOC_FORCE);
+  network->k =
+      engine_realloc(network->k, capacity * sizeof(double), ALLOC_FORCE);
+  network->impulse = engine_realloc(network->impulse,
+                                    capacity * sizeof(vector_t), ALLOC_FORCE);
+  assert(network->first != NULL && network->second != NULL &&
+         network->k != NULL && network->impulse != NULL);
+  network->spring_capacity = capacity;
+}
+
+void spring_network_add(spring_network_t *network, double k, list_t *bodies) {
+  assert(list_size(bodies) == 2);
+  spring_network_reserve_springs(network, network->springs + 1);
+  size_t s = network->springs;
+  network->first[s] =
+      spring_network_body_index(network, (body_t *)list_get(bodies, 0));
+  network->second[s] =
+      spring_network_body_index(network, (body_t *)list_get(bodies, 1));
+  network->k[s] = k;
+  network->impulse[s] = VEC_ZERO;
+  network->springs++;
+  list_free(bodies);
+}
+
+size_t spring_network_springs(spring_network_t *network) {
+  return network->springs;
+}
+
 void apply_drag(void *aux) {
   auxiliary_t *auxil = (auxiliary_t *)aux;
   body_t *body = (body_t *)list_get(auxil->bodies, 0);
@@ -190,21 +463,22 @@ void create_drag(scene_t *scene, double gamma, list_t *bodies) {
 }
 
 void apply_collision(void *aux) {
+  PROFILE_BEGIN(PROFILE_COLLISION);
   auxiliary_collision_t *auxil = (auxiliary_collision_t *)aux;
   body_t *body_1 = (body_t *)list_get(auxil->bodies, 0);
   body_t *body_2 = (body_t *)list_get(auxil->bodies, 1);
-  list_t *shape_1 = body_get_shape(body_1);
-  list_t *shape_2 = body_get_shape(body_2);
-  collision_info_t collision_info = find_collision(shape_1, shape_2);
-  list_free(shape_1);
-  list_free(shape_2);
+  // find_collision() only reads the shapes, so they need not be copied
+  collision_info_t collision_info = find_collision(
+      body_get_real_shape(body_1), body_get_real_shape(body_2));
   if (!collision_info.collided) {
     auxil->last_tick_collision = false;
+    PROFILE_END(PROFILE_COLLISION);
     return;
   }
   auxil->handler(auxil->last_tick_collision, body_1, body_2,
                  collision_info.axis, auxil->aux);
   auxil->last_tick_collision = true;
+  PROFILE_END(PROFILE_COLLISION);
 }
 
 void handle_destructive_collision(bool last_tick_collision, body_t *body1,
@@ -257,7 +531,8 @@ void create_destructive_collision(scene_t *scene, list_t *bodies) {
 void create_physics_collision(scene_t *scene, double elasticity,
                               list_t *bodies) {
   void *aux = physics_collision_aux_init(elasticity);
-  create_collision(scene, bodies, handle_physics_collision, aux, free);
+  create_collision(scene, bodies, handle_physics_collision, aux,
+                   physics_collision_aux_free);
 }
 
 void create_collision(scene_t *scene, list_t *bodies,
@@ -267,4 +542,266 @@ void create_collision(scene_t *scene, list_t *bodies,
       auxiliary_collision_init(aux, bodies, handler, freer);
   scene_add_bodies_force_creator(scene, apply_collision, aux_collision, bodies,
                                  (free_func_t)auxiliary_collision_free);
-}
\ No newline at end of file
+}
+
+typedef struct force_kind {
+  char *name;
+  // exactly one of forcer and handler is set
+  force_creator_t forcer;
+  collision_handler_t handler;
+  free_func_t freer;
+  aux_saver_t saver;
+  aux_loader_t loader;
+} force_kind_t;
+
+// a spring of a spring network as written by spring_network_save()
+typedef struct spring_record {
+  uint32_t first;
+  uint32_t second;
+  double k;
+} spring_record_t;
+
+// the registered kinds, which live as long as the program
+list_t *force_kinds = NULL;
+list_t *collision_kinds = NULL;
+
+void force_kind_free(force_kind_t *kind) {
+  engine_free(kind->name);
+  engine_free(kind);
+}
+
+force_kind_t *force_kind_find_name(list_t *kinds, const char *name) {
+  for (size_t i = 0; i < list_size(kinds); i++) {
+    force_kind_t *kind = list_get(kinds, i);
+    if (strcmp(kind->name, name) == 0) {
+      return kind;
+    }
+  }
+  return NULL;
+}
+
+void force_kind_add(list_t *kinds, const char *name, force_creator_t forcer,
+                    collision_handler_t handler, free_func_t freer,
+                    aux_saver_t saver, aux_loader_t loader) {
+  assert(strlen(name) <= UINT8_MAX);
+  assert(force_kind_find_name(kinds, name) == NULL);
+  force_kind_t *kind = engine_malloc(sizeof(force_kind_t), ALLOC_FORCE);
+  assert(kind != NULL);
+  kind->name = engine_malloc(strlen(name) + 1, ALLOC_FORCE);
+  assert(kind->name != NULL);
+  strcpy(kind->name, name);
+  kind->forcer = forcer;
+  kind->handler = handler;
+  kind->freer = freer;
+  kind->saver = saver;
+  kind->loader = loader;
+  list_add(kinds, kind);
+}
+
+bool auxiliary_save(auxiliary_t *aux, FILE *file) {
+  return fwrite(&aux->constant, sizeof(double), 1, file) == 1;
+}
+
+void *auxiliary_load(FILE *file, list_t *bodies, scene_t *scene,
+                     void *context) {
+  double constant;
+  if (bodies == NULL || fread(&constant, sizeof(double), 1, file) != 1) {
+    return NULL;
+  }
+  return auxiliary_init(constant, bodies);
+}
+
+bool spring_network_save(spring_network_t *network, FILE *file) {
+  uint32_t iterations = network->iterations;
+  uint32_t springs = network->springs;
+  bool written = fwrite(&iterations, sizeof(uint32_t), 1, file) == 1 &&
+                 fwrite(&springs, sizeof(uint32_t), 1, file) == 1;
+  for (size_t s = 0; written && s < springs; s++) {
+    spring_record_t record = {.first = network->first[s],
+                              .second = network->second[s],
+                              .k = network->k[s]};
+    written = fwrite(&record, sizeof(record), 1, file) == 1;
+  }
+  return written;
+}
+
+void *spring_network_load(FILE *file, list_t *bodies, scene_t *scene,
+                          void *context) {
+  uint32_t iterations, springs;
+  if (bodies == NULL || fread(&iterations, sizeof(uint32_t), 1, file) != 1 ||
+      iterations == 0 || fread(&springs, sizeof(uint32_t), 1, file) != 1) {
+    return NULL;
+  }
+  spring_network_t *network = spring_network_init(scene, iterations, bodies);
+  // the springs are read one at a time, so a corrupt count runs into the end
+  // of the file instead of an enormous allocation
+  bool read = true;
+  for (size_t s = 0; read && s < springs; s++) {
+    spring_record_t record;
+    read = fread(&record, sizeof(record), 1, file) == 1 &&
+           record.first < list_size(bodies) &&
+           record.second < list_size(bodies);
+    if (read) {
+      spring_network_reserve_springs(network, s + 1);
+      network->first[s] = record.first;
+      network->second[s] = record.second;
+      network->k[s] = record.k;
+      network->impulse[s] = VEC_ZERO;
+      network->springs++;
+    }
+  }
+  if (!read) {
+    spring_network_free(network);
+    return NULL;
+  }
+  return network;
+}
+
+bool force_kind_write(force_kind_t *kind, void *aux, FILE *file) {
+  uint8_t length = strlen(kind->name);
+  return fwrite(&length, 1, 1, file) == 1 &&
+         fwrite(kind->name, 1, length, file) == length &&
+         (kind->saver == NULL || kind->saver(aux, file));
+}
+
+// reads the name of a kind and finds it among the registered kinds
+force_kind_t *force_kind_read(list_t *kinds, FILE *file) {
+  uint8_t length;
+  char name[UINT8_MAX + 1];
+  if (fread(&length, 1, 1, file) != 1 ||
+      fread(name, 1, length, file) != length) {
+    return NULL;
+  }
+  name[length] = '\0';
+  return force_kind_find_name(kinds, name);
+}
+
+bool collision_save(auxiliary_collision_t *aux, FILE *file) {
+  force_kind_t *kind = NULL;
+  for (size_t i = 0; i < list_size(collision_kinds) && kind == NULL; i++) {
+    force_kind_t *candidate = list_get(collision_kinds, i);
+    if (candidate->handler == aux->handler) {
+      kind = candidate;
+    }
+  }
+  assert(kind != NULL && "collision handler was not registered");
+  return force_kind_write(kind, aux->aux, file) &&
+         fwrite(&aux->last_tick_collision, sizeof(bool), 1, file) == 1;
+}
+
+void *collision_load(FILE *file, list_t *bodies, scene_t *scene,
+                     void *context) {
+  force_kind_t *kind = force_kind_read(collision_kinds, file);
+  if (kind == NULL || bodies == NULL || list_size(bodies) != 2) {
+    return NULL;
+  }
+  void *handler_aux = NULL;
+  if (kind->loader != NULL) {
+    handler_aux = kind->loader(file, bodies, scene, context);
+    if (handler_aux == NULL) {
+      return NULL;
+    }
+  }
+  bool last_tick_collision;
+  if (fread(&last_tick_collision, sizeof(bool), 1, file) != 1) {
+    if (kind->freer != NULL) {
+      kind->freer(handler_aux);
+    }
+    return NULL;
+  }
+  auxiliary_collision_t *aux =
+      auxiliary_collision_init(handler_aux, bodies, kind->handler, kind->freer);
+  aux->last_tick_collision = last_tick_collision;
+  return aux;
+}
+
+bool physics_collision_aux_save(physics_collision_aux_t *aux, FILE *file) {
+  return fwrite(&aux->elasticity, sizeof(double), 1, file) == 1;
+}
+
+void *physics_collision_aux_load(FILE *file, list_t *bodies, scene_t *scene,
+                                 void *context) {
+  double elasticity;
+  if (fread(&elasticity, sizeof(double), 1, file) != 1) {
+    return NULL;
+  }
+  return physics_collision_aux_init(elasticity);
+}
+
+// registers the force creators and collision handlers defined here
+void force_kinds_init(void) {
+  if (force_kinds != NULL) {
+    return;
+  }
+  force_kinds = list_init(INITIAL_AUXES_SIZE, (free_func_t)force_kind_free);
+  collision_kinds =
+      list_init(INITIAL_AUXES_SIZE, (free_func_t)force_kind_free);
+  free_func_t auxiliary_freer = (free_func_t)auxiliary_free;
+  aux_saver_t auxiliary_saver = (aux_saver_t)auxiliary_save;
+  force_kind_add(force_kinds, "earth_gravity", apply_earth_gravity, NULL,
+                 auxiliary_freer, auxiliary_saver, auxiliary_load);
+  force_kind_add(force_kinds, "newtonian_gravity", apply_newtonian_gravity,
+                 NULL, auxiliary_freer, auxiliary_saver, auxiliary_load);
+  force_kind_add(force_kinds, "spring", apply_spring, NULL, auxiliary_freer,
+                 auxiliary_saver, auxiliary_load);
+  force_kind_add(force_kinds, "drag", apply_drag, NULL, auxiliary_freer,
+                 auxiliary_saver, auxiliary_load);
+  force_kind_add(force_kinds, "spring_network", apply_spring_network, NULL,
+                 (free_func_t)spring_network_free,
+                 (aux_saver_t)spring_network_save, spring_network_load);
+  force_kind_add(force_kinds, "collision", apply_collision, NULL,
+                 (free_func_t)auxiliary_collision_free,
+                 (aux_saver_t)collision_save, collision_load);
+  force_kind_add(collision_kinds, "destructive", NULL,
+                 handle_destructive_collision, NULL, NULL, NULL);
+  force_kind_add(collision_kinds, "physics", NULL, handle_physics_collision,
+                 physics_collision_aux_free,
+                 (aux_saver_t)physics_collision_aux_save,
+                 physics_collision_aux_load);
+}
+
+void register_force_kind(const char *name, force_creator_t forcer,
+                         free_func_t freer, aux_saver_t saver,
+                         aux_loader_t loader) {
+  force_kinds_init();
+  force_kind_add(force_kinds, name, forcer, NULL, freer, saver, loader);
+}
+
+void register_collision_kind(const char *name, collision_handler_t handler,
+                             free_func_t freer, aux_saver_t saver,
+                             aux_loader_t loader) {
+  force_kinds_init();
+  force_kind_add(collision_kinds, name, NULL, handler, freer, saver, loader);
+}
+
+bool force_kind_save(force_creator_t forcer, void *aux, FILE *file) {
+  force_kinds_init();
+  for (size_t i = 0; i < list_size(force_kinds); i++) {
+    force_kind_t *kind = list_get(force_kinds, i);
+    if (kind->forcer == forcer) {
+      return force_kind_write(kind, aux, file);
+    }
+  }
+  assert(false && "force creator was not registered");
+  return false;
+}
+
+bool force_kind_load(FILE *file, scene_t *scene, list_t *bodies,
+                     void *context) {
+  force_kinds_init();
+  force_kind_t *kind = force_kind_read(force_kinds, file);
+  // a kind without a loader has a NULL aux, which cannot hold bodies
+  if (kind == NULL || (kind->loader == NULL && bodies != NULL)) {
+    return false;
+  }
+  void *aux = NULL;
+  if (kind->loader != NULL) {
+    aux = kind->loader(file, bodies, scene, context);
+    if (aux == NULL) {
+      return false;
+    }
+  }
+  scene_add_bodies_force_creator(scene, kind->forcer, aux, bodies,
+                                 kind->freer);
+  return true;
+}
@@ -0,0 +1,186 @@
+#include "integrator.h"
+#include "alloc.h"
+#include "vector.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+double get_inverse_mass(body_t *body) {
+  double mass = body_get_mass(body);
+  return (mass == INFINITY || mass == 0) ? 0 : 1 / mass;
+}
+
+void finish_tick(body_t *body, double dt) {
+  double angular_velocity = body_get_angular_velocity(body);
+  if (angular_velocity != 0) {
+    body_set_rotation(body,
+                      body_get_rotation(body) + angular_velocity * dt);
+  }
+  body_reset_force_and_impulse(body);
+}
+
+void integrate_average_velocity(body_t **bodies, size_t count, double dt) {
+  for (size_t i = 0; i < count; i++) {
+    body_tick(bodies[i], dt);
+  }
+}
+
+void integrate_semi_implicit_euler(body_t **bodies, size_t count, double dt) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = bodies[i];
+    double inverse_mass = get_inverse_mass(body);
+    vector_t acceleration = vec_multiply(inverse_mass, body_get_force(body));
+    vector_t velocity = vec_add(
+        body_get_velocity(body),
+        vec_add(vec_multiply(dt, acceleration),
+                vec_multiply(inverse_mass, body_get_impulse(body))));
+    body_set_velocity(body, velocity);
+    body_set_acceleration(body, acceleration);
+    body_set_centroid(body, vec_add(body_get_centroid(body),
+                                    vec_multiply(dt, velocity)));
+    finish_tick(body, dt);
+  }
+}
+
+void integrate_velocity_verlet(body_t **bodies, size_t count, double dt) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = bodies[i];
+    double inverse_mass = get_inverse_mass(body);
+    vector_t acceleration = vec_multiply(inverse_mass, body_get_force(body));
+    // the reported velocity includes the previous tick's second half-kick
+    // estimated with its own acceleration; swap in the real one
+    vector_t velocity =
+        vec_add(body_get_velocity(body),
+                vec_multiply(inverse_mass, body_get_impulse(body)));
+    vector_t half_step_velocity = vec_add(
+        vec_subtract(velocity,
+                     vec_multiply(0.5 * dt, body_get_acceleration(body))),
+        vec_multiply(dt, acceleration));
+    body_set_centroid(body, vec_add(body_get_centroid(body),
+                                    vec_multiply(dt, half_step_velocity)));
+    body_set_velocity(body, vec_add(half_step_velocity,
+                                    vec_multiply(0.5 * dt, acceleration)));
+    body_set_acceleration(body, acceleration);
+    finish_tick(body, dt);
+  }
+}
+
+void rk4_workspace_reserve(rk4_workspace_t *workspace, size_t count) {
+  if (count <= workspace->capacity) {
+    return;
+  }
+  size_t capacity = 2 * count;
+  size_t size = capacity * sizeof(vector_t);
+  workspace->start_position =
+      engine_realloc(workspace->start_position, size, ALLOC_SCENE);
+  workspace->start_velocity =
+      engine_realloc(workspace->start_velocity, size, ALLOC_SCENE);
+  workspace->first_acceleration =
+      engine_realloc(workspace->first_acceleration, size, ALLOC_SCENE);
+  workspace->base_acceleration =
+      engine_realloc(workspace->base_acceleration, size, ALLOC_SCENE);
+  workspace->stage_velocity =
+      engine_realloc(workspace->stage_velocity, size, ALLOC_SCENE);
+  workspace->stage_acceleration =
+      engine_realloc(workspace->stage_acceleration, size, ALLOC_SCENE);
+  workspace->velocity_sum =
+      engine_realloc(workspace->velocity_sum, size, ALLOC_SCENE);
+  workspace->acceleration_sum =
+      engine_realloc(workspace->acceleration_sum, size, ALLOC_SCENE);
+  assert(workspace->start_position != NULL &&
+         workspace->start_velocity != NULL &&
+         workspace->first_acceleration != NULL &&
+         workspace->base_acceleration != NULL &&
+         workspace->stage_velocity != NULL &&
+         workspace->stage_acceleration != NULL &&
+         workspace->velocity_sum != NULL &&
+         workspace->acceleration_sum != NULL);
+  workspace->capacity = capacity;
+}
+
+void rk4_workspace_free(rk4_workspace_t *workspace) {
+  engine_free(workspace->start_position);
+  engine_free(workspace->start_velocity);
+  engine_free(workspace->first_acceleration);
+  engine_free(workspace->base_acceleration);
+  engine_free(workspace->stage_velocity);
+  engine_free(workspace->stage_acceleration);
+  engine_free(workspace->velocity_sum);
+  engine_free(workspace->acceleration_sum);
+  *workspace = (rk4_workspace_t){0};
+}
+
+void integrate_rk4(body_t **bodies, size_t count, double dt,
+                   force_evaluator_t evaluate, void *aux,
+                   rk4_workspace_t *workspace) {
+  rk4_workspace_reserve(workspace, count);
+  // first sample: everything the scene's force creators added this tick
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = bodies[i];
+    double inverse_mass = get_inverse_mass(body);
+    workspace->start_position[i] = body_get_centroid(body);
+    workspace->start_velocity[i] =
+        vec_add(body_get_velocity(body),
+                vec_multiply(inverse_mass, body_get_impulse(body)));
+    workspace->first_acceleration[i] =
+        vec_multiply(inverse_mass, body_get_force(body));
+    workspace->stage_velocity[i] = workspace->start_velocity[i];
+    workspace->stage_acceleration[i] = workspace->first_acceleration[i];
+    workspace->velocity_sum[i] = workspace->start_velocity[i];
+    workspace->acceleration_sum[i] = workspace->first_acceleration[i];
+    body_reset_force_and_impulse(body);
+    body_set_velocity(body, workspace->start_velocity[i]);
+  }
+  // the part of the first sample that evaluate() is able to resample
+  evaluate(aux);
+  for (size_t i = 0; i < count; i++) {
+    workspace->base_acceleration[i] =
+        vec_multiply(get_inverse_mass(bodies[i]), body_get_force(bodies[i]));
+    body_reset_force_and_impulse(bodies[i]);
+  }
+
+  for (size_t stage = 2; stage <= 4; stage++) {
+    double step = stage == 4 ? dt : 0.5 * dt;
+    double weight = stage == 4 ? 1 : 2;
+    for (size_t i = 0; i < count; i++) {
+      vector_t position =
+          vec_add(workspace->start_position[i],
+                  vec_multiply(step, workspace->stage_velocity[i]));
+      vector_t velocity =
+          vec_add(workspace->start_velocity[i],
+                  vec_multiply(step, workspace->stage_acceleration[i]));
+      body_set_centroid(bodies[i], position);
+      body_set_velocity(bodies[i], velocity);
+      workspace->stage_velocity[i] = velocity;
+    }
+    evaluate(aux);
+    for (size_t i = 0; i < count; i++) {
+      body_t *body = bodies[i];
+      vector_t resampled =
+          vec_multiply(get_inverse_mass(body), body_get_force(body));
+      workspace->stage_acceleration[i] =
+          vec_add(workspace->first_acceleration[i],
+                  vec_subtract(resampled, workspace->base_acceleration[i]));
+      workspace->velocity_sum[i] =
+          vec_add(workspace->velocity_sum[i],
+                  vec_multiply(weight, workspace->stage_velocity[i]));
+      workspace->acceleration_sum[i] =
+          vec_add(workspace->acceleration_sum[i],
+                  vec_multiply(weight, workspace->stage_acceleration[i]));
+      body_reset_force_and_impulse(body);
+    }
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = bodies[i];
+    body_set_centroid(
+        body, vec_add(workspace->start_position[i],
+                      vec_multiply(dt / 6, workspace->velocity_sum[i])));
+    body_set_velocity(
+        body, vec_add(workspace->start_velocity[i],
+                      vec_multiply(dt / 6, workspace->acceleration_sum[i])));
+    body_set_acceleration(
+        body, vec_multiply(1.0 / 6, workspace->acceleration_sum[i]));
+    finish_tick(body, dt);
+  }
+}
@@ -0,0 +1,138 @@
+#include "level.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char LEVEL_MAGIC[4] = {'J', 'Q', 'L', 'V'};
+const uint32_t LEVEL_VERSION = 1;
+
+// the start of a level file; the screen index follows it
+typedef struct level_header {
+  char magic[4];
+  uint32_t version;
+  uint32_t screen_count;
+  uint32_t platform_count;
+} level_header_t;
+
+typedef struct level {
+  void *data;
+  size_t size;
+  size_t screen_count;
+  // screen_count + 1 entries: screen s owns platforms
+  // screen_start[s] <= i < screen_start[s + 1]
+  const uint32_t *screen_start;
+  const level_platform_t *platforms;
+} level_t;
+
+// where the platforms start, after the header and index, aligned for doubles
+size_t level_platforms_offset(size_t screens) {
+  size_t offset = sizeof(level_header_t) + (screens + 1) * sizeof(uint32_t);
+  size_t alignment = sizeof(double);
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+level_t *level_open(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(level_header_t)) {
+    close(fd);
+    return NULL;
+  }
+  size_t size = info.st_size;
+  void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after the file is closed
+  close(fd);
+  if (data == MAP_FAILED) {
+    return NULL;
+  }
+
+  const level_header_t *header = data;
+  size_t screens = header->screen_count;
+  size_t offset = level_platforms_offset(screens);
+  const uint32_t *screen_start =
+      (const uint32_t *)((const char *)data + sizeof(level_header_t));
+  bool valid = memcmp(header->magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) == 0 &&
+               header->version == LEVEL_VERSION && offset <= size &&
+               (size - offset) / sizeof(level_platform_t) ==
+                   header->platform_count &&
+               screen_start[0] == 0 &&
+               screen_start[screens] == header->platform_count;
+  for (size_t s = 0; valid && s < screens; s++) {
+    valid = screen_start[s] <= screen_start[s + 1];
+  }
+  if (!valid) {
+    munmap(data, size);
+    return NULL;
+  }
+
+  level_t *level = malloc(sizeof(level_t));
+  assert(level != NULL);
+  level->data = data;
+  level->size = size;
+  level->screen_count = screens;
+  level->screen_start = screen_start;
+  level->platforms =
+      (const level_platform_t *)((const char *)data + offset);
+  return level;
+}
+
+void level_close(level_t *level) {
+  munmap(level->data, level->size);
+  free(level);
+}
+
+size_t level_screens(level_t *level) { return level->screen_count; }
+
+const level_platform_t *level_screen_platforms(level_t *level, size_t screen,
+                                               size_t *count) {
+  assert(screen < level->screen_count);
+  size_t start = level->screen_start[screen];
+  *count = level->screen_start[screen + 1] - start;
+  return level->platforms + start;
+}
+
+bool level_write(const char *path, size_t screens,
+                 const level_platform_t *platforms, size_t count) {
+  uint32_t *screen_start = malloc((screens + 1) * sizeof(uint32_t));
+  assert(screen_start != NULL);
+  size_t platform = 0;
+  for (size_t s = 0; s <= screens; s++) {
+    screen_start[s] = platform;
+    while (s < screens && platform < count &&
+           platforms[platform].screen == s) {
+      platform++;
+    }
+  }
+  // anything left over was out of order or beyond the last screen
+  assert(platform == count);
+
+  level_header_t header = {.version = LEVEL_VERSION,
+                           .screen_count = screens,
+                           .platform_count = count};
+  memcpy(header.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+  size_t index_size = (screens + 1) * sizeof(uint32_t);
+  size_t padding =
+      level_platforms_offset(screens) - sizeof(header) - index_size;
+  const char zeros[sizeof(double)] = {0};
+
+  FILE *file = fopen(path, "wb");
+  bool written = file != NULL &&
+                 fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 fwrite(screen_start, index_size, 1, file) == 1 &&
+                 fwrite(zeros, 1, padding, file) == padding &&
+                 fwrite(platforms, sizeof(level_platform_t), count, file) ==
+                     count;
+  if (file != NULL) {
+    written = fclose(file) == 0 && written;
+  }
+  free(screen_start);
+  return written;
+}
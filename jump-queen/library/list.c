@@ -1,8 +1,18 @@
 #include "list.h"
+#include "alloc.h"
+#include "pool.h"
 #include <assert.h>
 #include <stdlib.h>
 
 const double RESIZE_FACTOR = 2.0;
+const size_t LIST_POOL_CHUNK = 256;
+// capacities of the data arrays that come from pools instead of malloc();
+// smaller lists are rounded up to the next one
+#define LIST_SIZE_CLASSES 3
+const size_t LIST_CLASS_CAPACITIES[LIST_SIZE_CLASSES] = {4, 8, 16};
+
+pool_t *list_pool = NULL;
+pool_t *list_data_pools[LIST_SIZE_CLASSES] = {NULL};
 
 typedef struct list {
   void **data;
@@ -11,13 +21,42 @@ typedef struct list {
   free_func_t freer;
 } list_t;
 
+// allocates a data array, rounding small capacities up to a pooled size
+void **list_data_alloc(size_t *capacity) {
+  for (size_t i = 0; i < LIST_SIZE_CLASSES; i++) {
+    if (*capacity <= LIST_CLASS_CAPACITIES[i]) {
+      if (list_data_pools[i] == NULL) {
+        list_data_pools[i] = pool_init(
+            LIST_CLASS_CAPACITIES[i] * sizeof(void *), LIST_POOL_CHUNK);
+      }
+      *capacity = LIST_CLASS_CAPACITIES[i];
+      return pool_alloc(list_data_pools[i]);
+    }
+  }
+  void **data = engine_malloc(*capacity * sizeof(void *), ALLOC_LIST);
+  assert(data != NULL);
+  return data;
+}
+
+void list_data_release(void **data, size_t capacity) {
+  for (size_t i = 0; i < LIST_SIZE_CLASSES; i++) {
+    if (capacity == LIST_CLASS_CAPACITIES[i]) {
+      pool_release(list_data_pools[i], data);
+      return;
+    }
+  }
+  engine_free(data);
+}
+
 list_t *list_init(size_t initial_size, free_func_t freer) {
-  list_t *list = malloc(sizeof(list_t));
-  list->data = malloc(initial_size * sizeof(void *));
+  if (list_pool == NULL) {
+    list_pool = pool_init(sizeof(list_t), LIST_POOL_CHUNK);
+  }
+  list_t *list = pool_alloc(list_pool);
   list->capacity = initial_size;
+  list->data = list_data_alloc(&list->capacity);
   list->freer = freer;
   list->size = 0;
-  assert(list->data != NULL);
   return list;
 }
 
@@ -27,8 +66,8 @@ void list_free(list_t *list) {
       list->freer(list->data[i]);
     }
   }
-  free(list->data);
-  free(list);
+  list_data_release(list->data, list->capacity);
+  pool_release(list_pool, list);
 }
 
 size_t list_size(list_t *list) { return list->size; }
@@ -48,13 +87,26 @@ void *list_remove(list_t *list, size_t index) {
   return removed;
 }
 
+void *list_set(list_t *list, size_t index, void *value) {
+  void *replaced = list_get(list, index);
+  assert(value != NULL);
+  list->data[index] = value;
+  return replaced;
+}
+
+void list_truncate(list_t *list, size_t size) {
+  assert(size <= list->size);
+  list->size = size;
+}
+
 void list_resize(list_t *list) {
-  void **resized = malloc(sizeof(void *) * list->capacity * RESIZE_FACTOR);
+  size_t capacity = list->capacity * RESIZE_FACTOR;
+  void **resized = list_data_alloc(&capacity);
   for (int i = 0; i < list->size; i++) {
     resized[i] = list->data[i];
   }
-  list->capacity *= RESIZE_FACTOR;
-  free(list->data);
+  list_data_release(list->data, list->capacity);
+  list->capacity = capacity;
   list->data = resized;
 }
 
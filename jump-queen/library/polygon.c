@@ -62,19 +62,17 @@ void polygon_dilate(list_t *polygon, double factor) {
 }
 
 list_t *make_closed_polygon(double length, int points) {
-  list_t *polygon = list_init(points, free);
+  list_t *polygon = list_init(points, vec_free);
   double angle = M_PI * 2 / points;
   for (int i = 0; i < points; i++) {
-    vector_t *v = malloc(sizeof(vector_t));
-    *v = vec_rotate((vector_t){0, length}, angle * i);
-    list_add(polygon, v);
+    list_add(polygon, vec_alloc(vec_rotate((vector_t){0, length}, angle * i)));
   }
   return polygon;
 }
 
 list_t *make_star(int points, double inner_radius, double outer_radius,
                   vector_t center, double angle) {
-  list_t *star = list_init(points * 2, free);
+  list_t *star = list_init(points * 2, vec_free);
   list_t *poly = make_closed_polygon(outer_radius, points);
   list_t *poly1 = make_closed_polygon(inner_radius, points);
   polygon_rotate(poly1, M_PI / points, VEC_ZERO);
@@ -82,25 +80,22 @@ list_t *make_star(int points, double inner_radius, double outer_radius,
     list_add(star, list_get(poly, i));
     list_add(star, list_get(poly1, i));
   }
+  // the vertices now belong to star
+  list_truncate(poly, 0);
+  list_truncate(poly1, 0);
+  list_free(poly);
+  list_free(poly1);
   polygon_rotate(star, angle, VEC_ZERO);
   polygon_translate(star, center);
   return star;
 }
 
 list_t *make_rectangle(vector_t corner_one, vector_t corner_two) {
-  list_t *rect = list_init(4, free);
-  vector_t *v = malloc(sizeof(vector_t));
-  *v = (vector_t){corner_two.x, corner_two.y};
-  list_add(rect, v);
-  v = malloc(sizeof(vector_t));
-  *v = (vector_t){corner_one.x, corner_two.y};
-  list_add(rect, v);
-  v = malloc(sizeof(vector_t));
-  *v = (vector_t){corner_one.x, corner_one.y};
-  list_add(rect, v);
-  v = malloc(sizeof(vector_t));
-  *v = (vector_t){corner_two.x, corner_one.y};
-  list_add(rect, v);
+  list_t *rect = list_init(4, vec_free);
+  list_add(rect, vec_alloc((vector_t){corner_two.x, corner_two.y}));
+  list_add(rect, vec_alloc((vector_t){corner_one.x, corner_two.y}));
+  list_add(rect, vec_alloc((vector_t){corner_one.x, corner_one.y}));
+  list_add(rect, vec_alloc((vector_t){corner_two.x, corner_one.y}));
   return rect;
 }
 
@@ -0,0 +1,94 @@
+#include "pool.h"
+#include "alloc.h"
+#include <assert.h>
+#include <stdlib.h>
+
+const size_t POOL_ALIGNMENT = _Alignof(max_align_t);
+
+typedef struct pool_chunk {
+  struct pool_chunk *next;
+  max_align_t data[];
+} pool_chunk_t;
+
+// released objects hold a pointer to the next free object
+typedef struct pool_node {
+  struct pool_node *next;
+} pool_node_t;
+
+typedef struct pool {
+  size_t object_size;
+  size_t chunk_objects;
+  pool_chunk_t *chunks;
+  pool_node_t *free_list;
+  size_t live;
+  size_t capacity;
+} pool_t;
+
+pool_t *pool_init(size_t object_size, size_t chunk_objects) {
+  assert(chunk_objects > 0);
+  pool_t *pool = engine_malloc(sizeof(pool_t), ALLOC_POOL);
+  assert(pool != NULL);
+  if (object_size < sizeof(pool_node_t)) {
+    object_size = sizeof(pool_node_t);
+  }
+  pool->object_size =
+      (object_size + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT * POOL_ALIGNMENT;
+  pool->chunk_objects = chunk_objects;
+  pool->chunks = NULL;
+  pool->free_list = NULL;
+  pool->live = 0;
+  pool->capacity = 0;
+  return pool;
+}
+
+void pool_free(pool_t *pool) {
+  pool_chunk_t *chunk = pool->chunks;
+  while (chunk != NULL) {
+    pool_chunk_t *next = chunk->next;
+    engine_free(chunk);
+    chunk = next;
+  }
+  engine_free(pool);
+}
+
+void pool_grow(pool_t *pool) {
+  pool_chunk_t *chunk = engine_malloc(
+      sizeof(pool_chunk_t) + pool->object_size * pool->chunk_objects,
+      ALLOC_POOL);
+  assert(chunk != NULL);
+  chunk->next = pool->chunks;
+  pool->chunks = chunk;
+  // threads the new objects onto the free list in address order
+  char *objects = (char *)chunk->data;
+  for (size_t i = pool->chunk_objects; i > 0; i--) {
+    pool_node_t *node = (pool_node_t *)(objects + (i - 1) * pool->object_size);
+    node->next = pool->free_list;
+    pool->free_list = node;
+  }
+  pool->capacity += pool->chunk_objects;
+}
+
+void *pool_alloc(pool_t *pool) {
+  if (pool->free_list == NULL) {
+    pool_grow(pool);
+  }
+  pool_node_t *node = pool->free_list;
+  pool->free_list = node->next;
+  pool->live++;
+  return node;
+}
+
+void pool_release(pool_t *pool, void *object) {
+  if (object == NULL) {
+    return;
+  }
+  assert(pool->live > 0);
+  pool_node_t *node = (pool_node_t *)object;
+  node->next = pool->free_list;
+  pool->free_list = node;
+  pool->live--;
+}
+
+size_t pool_live(pool_t *pool) { return pool->live; }
+
+size_t pool_capacity(pool_t *pool) { return pool->capacity; }
@@ -0,0 +1,187 @@
+#include "profile.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+const char *const PROFILE_PHASE_NAMES[] = {
+    "tick",      "forces",    "removal", "integrate",
+    "collision", "body_tick", "render",  "frame"};
+const size_t PROFILE_TRACE_CAPACITY = 1 << 20;
+const char PROFILE_REPORT_VARIABLE[] = "PROFILE_REPORT";
+const char PROFILE_TRACE_VARIABLE[] = "PROFILE_TRACE";
+
+/** One probe, kept for the trace */
+typedef struct trace_event {
+  uint64_t start;
+  uint64_t duration;
+  profile_phase_t phase;
+} trace_event_t;
+
+/** Totals since the last reset, and since the last frame ended */
+profile_stats_t profile_totals[PROFILE_PHASES];
+profile_stats_t profile_frame_stats[PROFILE_PHASES];
+uint64_t last_frame_end;
+size_t frames_profiled = 0;
+FILE *frame_report = NULL;
+
+/** The trace buffer, which grows up to PROFILE_TRACE_CAPACITY events */
+bool tracing = false;
+trace_event_t *trace_events = NULL;
+size_t trace_size = 0, trace_capacity = 0, trace_dropped = 0;
+uint64_t trace_origin;
+
+/** Where profile_start() writes the trace at exit */
+const char *trace_path = NULL;
+
+uint64_t profile_now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+/** Buffers a trace event, dropping it if the buffer is full */
+void trace_add(profile_phase_t phase, uint64_t start, uint64_t duration) {
+  if (trace_size == trace_capacity) {
+    if (trace_capacity == PROFILE_TRACE_CAPACITY) {
+      trace_dropped++;
+      return;
+    }
+    trace_capacity = trace_capacity == 0 ? 1024 : 2 * trace_capacity;
+    if (trace_capacity > PROFILE_TRACE_CAPACITY) {
+      trace_capacity = PROFILE_TRACE_CAPACITY;
+    }
+    trace_events =
+        realloc(trace_events, trace_capacity * sizeof(*trace_events));
+    assert(trace_events != NULL);
+  }
+  trace_events[trace_size++] =
+      (trace_event_t){.start = start, .duration = duration, .phase = phase};
+}
+
+void profile_record(profile_phase_t phase, uint64_t start) {
+  uint64_t duration = profile_now() - start;
+  profile_totals[phase].count++;
+  profile_totals[phase].ns += duration;
+  profile_frame_stats[phase].count++;
+  profile_frame_stats[phase].ns += duration;
+  if (tracing) {
+    trace_add(phase, start, duration);
+  }
+}
+
+void profile_frame(void) {
+  profile_record(PROFILE_FRAME, last_frame_end);
+  last_frame_end = profile_now();
+  if (frame_report != NULL) {
+    fprintf(frame_report, "frame %zu:", frames_profiled);
+    for (size_t i = 0; i < PROFILE_PHASES; i++) {
+      profile_stats_t stats = profile_frame_stats[i];
+      if (stats.count > 0) {
+        fprintf(frame_report, " %s %zux %.1f us", PROFILE_PHASE_NAMES[i],
+                stats.count, stats.ns / 1e3);
+      }
+    }
+    fputc('\n', frame_report);
+  }
+  frames_profiled++;
+  for (size_t i = 0; i < PROFILE_PHASES; i++) {
+    profile_frame_stats[i] = (profile_stats_t){0, 0};
+  }
+}
+
+profile_stats_t profile_get(profile_phase_t phase) {
+  assert(phase < PROFILE_PHASES);
+  return profile_totals[phase];
+}
+
+const char *profile_phase_name(profile_phase_t phase) {
+  assert(phase < PROFILE_PHASES);
+  return PROFILE_PHASE_NAMES[phase];
+}
+
+void profile_reset(void) {
+  for (size_t i = 0; i < PROFILE_PHASES; i++) {
+    profile_totals[i] = (profile_stats_t){0, 0};
+    profile_frame_stats[i] = (profile_stats_t){0, 0};
+  }
+  frames_profiled = 0;
+  trace_size = 0;
+  trace_dropped = 0;
+  trace_origin = profile_now();
+  last_frame_end = trace_origin;
+}
+
+void profile_report(FILE *file) {
+  fprintf(file, "%-10s %10s %14s %12s\n", "phase", "calls", "total ms",
+          "avg us");
+  for (size_t i = 0; i < PROFILE_PHASES; i++) {
+    profile_stats_t stats = profile_totals[i];
+    if (stats.count == 0) {
+      continue;
+    }
+    fprintf(file, "%-10s %10zu %14.3f %12.3f\n", PROFILE_PHASE_NAMES[i],
+            stats.count, stats.ns / 1e6, stats.ns / 1e3 / stats.count);
+  }
+}
+
+void profile_report_frames(FILE *file) { frame_report = file; }
+
+void profile_trace_start(void) {
+  tracing = true;
+  if (trace_size == 0) {
+    trace_origin = profile_now();
+  }
+}
+
+bool profile_trace_write(FILE *file) {
+  bool written = fputs("{\"traceEvents\":[\n", file) >= 0;
+  for (size_t i = 0; i < trace_size && written; i++) {
+    trace_event_t *event = &trace_events[i];
+    // Chrome traces are in microseconds
+    written = fprintf(file,
+                      "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                      "\"ts\":%.3f,\"dur\":%.3f}\n",
+                      i == 0 ? "" : ",", PROFILE_PHASE_NAMES[event->phase],
+                      (double)(int64_t)(event->start - trace_origin) / 1e3,
+                      event->duration / 1e3) > 0;
+  }
+  return written &&
+         fprintf(file,
+                 "],\"displayTimeUnit\":\"ns\","
+                 "\"otherData\":{\"dropped_events\":%zu}}\n",
+                 trace_dropped) > 0;
+}
+
+/** Writes the trace and prints the summary; registered with atexit() */
+void profile_stop(void) {
+  if (frame_report != NULL) {
+    profile_report(frame_report);
+  }
+  if (trace_path != NULL) {
+    FILE *file = fopen(trace_path, "w");
+    if (file == NULL || !profile_trace_write(file)) {
+      fprintf(stderr, "Could not write the profile trace %s\n", trace_path);
+    }
+    if (file != NULL) {
+      fclose(file);
+    }
+  }
+  free(trace_events);
+  trace_events = NULL;
+  trace_size = trace_capacity = 0;
+  tracing = false;
+}
+
+void profile_start(void) {
+  profile_reset();
+  const char *report = getenv(PROFILE_REPORT_VARIABLE);
+  if (report != NULL && report[0] != '\0' && report[0] != '0') {
+    profile_report_frames(stdout);
+  }
+  const char *path = getenv(PROFILE_TRACE_VARIABLE);
+  if (path != NULL && path[0] != '\0') {
+    trace_path = path;
+    profile_trace_start();
+  }
+  atexit(profile_stop);
+}
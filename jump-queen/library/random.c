@@ -1,20 +1,147 @@
 #include "random.h"
+#include <assert.h>
+#include <stdbool.h>
 
-int r_sign() { return rand() % 2 == 0 ? 1 : -1; }
+// The 2^128 jump polynomial from the xoshiro256** reference implementation
+const uint64_t RNG_JUMP[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                             0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+const size_t RNG_STATE_WORDS = 4;
+const double RNG_DOUBLE_UNIT = 0x1.0p-53;
 
-int r_int(int min, int max) { return min + rand() % (max - min + 1); }
+/** The generator behind the r_* functions, seeded on first use */
+rng_t global_rng;
+bool global_rng_seeded = false;
 
-double r_double(double min, double max) {
-  return min + ((rand() * 1.0 / RAND_MAX) * (max - min));
+uint64_t rotate_left(uint64_t x, int bits) {
+  return (x << bits) | (x >> (64 - bits));
+}
+
+/** Steps a splitmix64 generator, which spreads a seed over the state */
+uint64_t splitmix_next(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+void rng_seed(rng_t *rng, uint64_t seed) {
+  // splitmix64 never gives four zeros in a row, which xoshiro can't escape
+  for (size_t i = 0; i < RNG_STATE_WORDS; i++) {
+    rng->state[i] = splitmix_next(&seed);
+  }
 }
 
-rgb_color_t r_color() {
-  return (rgb_color_t){r_double(0, 1), r_double(0, 1), r_double(0, 1)};
+uint64_t rng_next(rng_t *rng) {
+  uint64_t *s = rng->state;
+  uint64_t result = rotate_left(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotate_left(s[3], 45);
+  return result;
 }
 
-rgb_color_t r_pastel_color() {
-  rgb_color_t color = r_color();
+void rng_jump(rng_t *rng) {
+  uint64_t jumped[4] = {0, 0, 0, 0};
+  for (size_t i = 0; i < RNG_STATE_WORDS; i++) {
+    for (int bit = 0; bit < 64; bit++) {
+      if (RNG_JUMP[i] & (uint64_t)1 << bit) {
+        for (size_t j = 0; j < RNG_STATE_WORDS; j++) {
+          jumped[j] ^= rng->state[j];
+        }
+      }
+      rng_next(rng);
+    }
+  }
+  for (size_t j = 0; j < RNG_STATE_WORDS; j++) {
+    rng->state[j] = jumped[j];
+  }
+}
+
+rng_t rng_split(rng_t *rng) {
+  rng_t stream = *rng;
+  rng_jump(rng);
+  return stream;
+}
+
+int rng_sign(rng_t *rng) {
+  // the high bits are the best ones
+  return rng_next(rng) >> 63 ? 1 : -1;
+}
+
+int rng_int(rng_t *rng, int min, int max) {
+  assert(min <= max);
+  // scale 32 random bits to the range instead of taking a remainder
+  uint64_t range = (uint64_t)((int64_t)max - min + 1);
+  return (int)(min + (int64_t)(((rng_next(rng) >> 32) * range) >> 32));
+}
+
+double rng_double(rng_t *rng, double min, double max) {
+  return min + (rng_next(rng) >> 11) * RNG_DOUBLE_UNIT * (max - min);
+}
+
+rgb_color_t rng_color(rng_t *rng) {
+  return (rgb_color_t){rng_double(rng, 0, 1), rng_double(rng, 0, 1),
+                       rng_double(rng, 0, 1)};
+}
+
+rgb_color_t rng_pastel_color(rng_t *rng) {
+  rgb_color_t color = rng_color(rng);
   color = (rgb_color_t){0.5 * (color.r + 1), 0.5 * (color.g + 1),
                         0.5 * (color.b + 1)};
   return color;
-}
\ No newline at end of file
+}
+
+void rng_fill_doubles(rng_t *rng, double *values, size_t count, double min,
+                      double max) {
+  // work on a copy of the state so it can stay in registers
+  rng_t local = *rng;
+  double scale = RNG_DOUBLE_UNIT * (max - min);
+  for (size_t i = 0; i < count; i++) {
+    values[i] = min + (rng_next(&local) >> 11) * scale;
+  }
+  *rng = local;
+}
+
+void rng_fill_colors(rng_t *rng, rgb_color_t *colors, size_t count) {
+  rng_t local = *rng;
+  for (size_t i = 0; i < count; i++) {
+    colors[i] = rng_color(&local);
+  }
+  *rng = local;
+}
+
+rng_t *r_global() {
+  if (!global_rng_seeded) {
+    r_seed(0);
+  }
+  return &global_rng;
+}
+
+void r_seed(uint64_t seed) {
+  rng_seed(&global_rng, seed);
+  global_rng_seeded = true;
+}
+
+int r_sign() { return rng_sign(r_global()); }
+
+int r_int(int min, int max) { return rng_int(r_global(), min, max); }
+
+double r_double(double min, double max) {
+  return rng_double(r_global(), min, max);
+}
+
+rgb_color_t r_color() { return rng_color(r_global()); }
+
+rgb_color_t r_pastel_color() { return rng_pastel_color(r_global()); }
+
+void r_fill_doubles(double *values, size_t count, double min, double max) {
+  rng_fill_doubles(r_global(), values, count, min, max);
+}
+
+void r_fill_colors(rgb_color_t *colors, size_t count) {
+  rng_fill_colors(r_global(), colors, count);
+}
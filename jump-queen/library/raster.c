@@ -0,0 +1,205 @@
+#include "raster.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * A non-horizontal polygon edge, spanning top <= y < bottom,
+ * along which x = x_top + (y - top) * slope.
+ */
+typedef struct edge {
+  double top;
+  double bottom;
+  double x_top;
+  double slope;
+} edge_t;
+
+typedef struct raster {
+  size_t width;
+  size_t height;
+  uint32_t *pixels;
+  // The edges of the polygon being filled and where the current scanline
+  // crosses them. Kept between polygons so they only need to grow.
+  edge_t *edges;
+  double *crossings;
+  size_t edge_capacity;
+} raster_t;
+
+raster_t *raster_init(size_t width, size_t height) {
+  assert(width > 0 && height > 0);
+  raster_t *raster = malloc(sizeof(raster_t));
+  assert(raster != NULL);
+  raster->width = width;
+  raster->height = height;
+  raster->pixels = malloc(width * height * sizeof(*raster->pixels));
+  assert(raster->pixels != NULL);
+  raster->edges = NULL;
+  raster->crossings = NULL;
+  raster->edge_capacity = 0;
+  return raster;
+}
+
+void raster_free(raster_t *raster) {
+  free(raster->pixels);
+  free(raster->edges);
+  free(raster->crossings);
+  free(raster);
+}
+
+size_t raster_width(raster_t *raster) { return raster->width; }
+
+size_t raster_height(raster_t *raster) { return raster->height; }
+
+uint32_t *raster_pixels(raster_t *raster) { return raster->pixels; }
+
+void raster_fill_span(uint32_t *pixels, size_t count, uint32_t color) {
+  size_t i = 0;
+#ifdef __SSE2__
+  __m128i fill = _mm_set1_epi32(color);
+  for (; i + 8 <= count; i += 8) {
+    _mm_storeu_si128((__m128i *)(pixels + i), fill);
+    _mm_storeu_si128((__m128i *)(pixels + i + 4), fill);
+  }
+  if (i + 4 <= count) {
+    _mm_storeu_si128((__m128i *)(pixels + i), fill);
+    i += 4;
+  }
+#endif
+  for (; i < count; i++) {
+    pixels[i] = color;
+  }
+}
+
+void raster_clear(raster_t *raster, uint32_t color) {
+  raster_fill_span(raster->pixels, raster->width * raster->height, color);
+}
+
+/** Converts a crossing to the first pixel whose center is right of it */
+long first_pixel_after(double x) { return (long)ceil(x - 0.5); }
+
+void raster_fill_polygon(raster_t *raster, const vector_t *points, size_t n,
+                         uint32_t color) {
+  assert(n >= 3);
+  if (n > raster->edge_capacity) {
+    raster->edge_capacity = 2 * n;
+    raster->edges =
+        realloc(raster->edges, raster->edge_capacity * sizeof(*raster->edges));
+    raster->crossings = realloc(
+        raster->crossings, raster->edge_capacity * sizeof(*raster->crossings));
+    assert(raster->edges != NULL && raster->crossings != NULL);
+  }
+  // find each edge's slope once instead of once per scanline
+  edge_t *edges = raster->edges;
+  size_t edge_count = 0;
+  double min_y = points[0].y, max_y = points[0].y;
+  for (size_t i = 0; i < n; i++) {
+    vector_t a = points[i], b = points[i + 1 < n ? i + 1 : 0];
+    min_y = fmin(min_y, a.y);
+    max_y = fmax(max_y, a.y);
+    if (a.y == b.y) {
+      continue;
+    }
+    if (a.y > b.y) {
+      vector_t swap = a;
+      a = b;
+      b = swap;
+    }
+    edges[edge_count++] = (edge_t){.top = a.y,
+                                   .bottom = b.y,
+                                   .x_top = a.x,
+                                   .slope = (b.x - a.x) / (b.y - a.y)};
+  }
+  long first_row = first_pixel_after(min_y), end_row = first_pixel_after(max_y);
+  if (first_row < 0) {
+    first_row = 0;
+  }
+  if (end_row > (long)raster->height) {
+    end_row = raster->height;
+  }
+
+  double *crossings = raster->crossings;
+  for (long row = first_row; row < end_row; row++) {
+    // sample through pixel centers
+    double y = row + 0.5;
+    size_t count = 0;
+    for (size_t i = 0; i < edge_count; i++) {
+      edge_t *edge = &edges[i];
+      if (edge->top <= y && y < edge->bottom) {
+        double x = edge->x_top + (y - edge->top) * edge->slope;
+        // insertion sort: there are only ever a few crossings
+        size_t j = count++;
+        while (j > 0 && crossings[j - 1] > x) {
+          crossings[j] = crossings[j - 1];
+          j--;
+        }
+        crossings[j] = x;
+      }
+    }
+    uint32_t *pixels = raster->pixels + row * raster->width;
+    for (size_t i = 0; i + 1 < count; i += 2) {
+      long start = first_pixel_after(crossings[i]),
+           end = first_pixel_after(crossings[i + 1]);
+      if (start < 0) {
+        start = 0;
+      }
+      if (end > (long)raster->width) {
+        end = raster->width;
+      }
+      if (end > start) {
+        raster_fill_span(pixels + start, end - start, color);
+      }
+    }
+  }
+}
+
+/** Sets a pixel if it is inside the framebuffer */
+void raster_plot(raster_t *raster, long x, long y, uint32_t color) {
+  if (0 <= x && x < (long)raster->width && 0 <= y &&
+      y < (long)raster->height) {
+    raster->pixels[y * raster->width + x] = color;
+  }
+}
+
+/** Sets a horizontal run of pixels, clipped to the framebuffer */
+void raster_row(raster_t *raster, long start, long end, long y,
+                uint32_t color) {
+  if (y < 0 || y >= (long)raster->height) {
+    return;
+  }
+  if (start < 0) {
+    start = 0;
+  }
+  if (end > (long)raster->width) {
+    end = raster->width;
+  }
+  if (end > start) {
+    raster_fill_span(raster->pixels + y * raster->width + start, end - start,
+                     color);
+  }
+}
+
+void raster_outline_rect(raster_t *raster, long x, long y, long width,
+                         long height, uint32_t color) {
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+  raster_row(raster, x, x + width, y, color);
+  raster_row(raster, x, x + width, y + height - 1, color);
+  for (long row = y + 1; row < y + height - 1; row++) {
+    raster_plot(raster, x, row, color);
+    raster_plot(raster, x + width - 1, row, color);
+  }
+}
+
+void raster_read_rgb(raster_t *raster, uint8_t *rgb) {
+  size_t count = raster->width * raster->height;
+  for (size_t i = 0; i < count; i++) {
+    uint32_t pixel = raster->pixels[i];
+    rgb[3 * i] = pixel >> 16;
+    rgb[3 * i + 1] = pixel >> 8;
+    rgb[3 * i + 2] = pixel;
+  }
+}
@@ -0,0 +1,148 @@
+#include "replay.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char REPLAY_MAGIC[4] = {'J', 'Q', 'R', 'P'};
+const uint32_t REPLAY_VERSION = 1;
+// the first byte of each record
+const uint8_t REPLAY_TICK_TAG = 'T';
+const uint8_t REPLAY_KEY_TAG = 'K';
+// the sizes of the records, including their tags
+const size_t REPLAY_TICK_SIZE = 1 + sizeof(double);
+const size_t REPLAY_KEY_SIZE = 1 + 2 + sizeof(double);
+
+// the start of a log file
+typedef struct replay_header {
+  char magic[4];
+  uint32_t version;
+  uint64_t seed;
+} replay_header_t;
+
+typedef struct replay {
+  uint64_t seed;
+  size_t ticks;
+  // the file being recorded to, or NULL when playing back
+  FILE *file;
+  // the records being played back, and how far they have been read
+  uint8_t *records;
+  size_t size;
+  size_t position;
+} replay_t;
+
+replay_t *replay_init(uint64_t seed) {
+  replay_t *replay = malloc(sizeof(replay_t));
+  assert(replay != NULL);
+  replay->seed = seed;
+  replay->ticks = 0;
+  replay->file = NULL;
+  replay->records = NULL;
+  replay->size = 0;
+  replay->position = 0;
+  return replay;
+}
+
+replay_t *replay_record(const char *path, uint64_t seed) {
+  replay_t *replay = replay_init(seed);
+  replay->file = fopen(path, "wb");
+  assert(replay->file != NULL);
+  replay_header_t header = {.version = REPLAY_VERSION, .seed = seed};
+  memcpy(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+  fwrite(&header, sizeof(header), 1, replay->file);
+  return replay;
+}
+
+replay_t *replay_play(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return NULL;
+  }
+  replay_header_t header;
+  long size = -1;
+  if (fread(&header, sizeof(header), 1, file) == 1 &&
+      memcmp(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) == 0 &&
+      header.version == REPLAY_VERSION && fseek(file, 0, SEEK_END) == 0) {
+    size = ftell(file) - (long)sizeof(header);
+  }
+  if (size < 0 || fseek(file, sizeof(header), SEEK_SET) != 0) {
+    fclose(file);
+    return NULL;
+  }
+  replay_t *replay = replay_init(header.seed);
+  replay->size = size;
+  replay->records = malloc(size > 0 ? size : 1);
+  assert(replay->records != NULL);
+  bool read = fread(replay->records, 1, size, file) == (size_t)size;
+  fclose(file);
+  if (!read) {
+    replay_close(replay);
+    return NULL;
+  }
+  return replay;
+}
+
+void replay_close(replay_t *replay) {
+  if (replay->file != NULL) {
+    fclose(replay->file);
+  }
+  free(replay->records);
+  free(replay);
+}
+
+uint64_t replay_seed(replay_t *replay) { return replay->seed; }
+
+size_t replay_ticks(replay_t *replay) { return replay->ticks; }
+
+void replay_write_tick(replay_t *replay, double dt) {
+  assert(replay->file != NULL);
+  uint8_t record[REPLAY_TICK_SIZE];
+  record[0] = REPLAY_TICK_TAG;
+  memcpy(record + 1, &dt, sizeof(double));
+  fwrite(record, sizeof(record), 1, replay->file);
+  replay->ticks++;
+}
+
+void replay_write_key(replay_t *replay, key_event_t event) {
+  assert(replay->file != NULL);
+  uint8_t record[REPLAY_KEY_SIZE];
+  record[0] = REPLAY_KEY_TAG;
+  record[1] = event.key;
+  record[2] = event.type;
+  memcpy(record + 3, &event.held_time, sizeof(double));
+  fwrite(record, sizeof(record), 1, replay->file);
+}
+
+replay_record_t replay_next(replay_t *replay) {
+  assert(replay->file == NULL);
+  size_t left = replay->size - replay->position;
+  if (left == 0) {
+    return REPLAY_END;
+  }
+  uint8_t tag = replay->records[replay->position];
+  if (tag == REPLAY_TICK_TAG && left >= REPLAY_TICK_SIZE) {
+    return REPLAY_TICK;
+  }
+  if (tag == REPLAY_KEY_TAG && left >= REPLAY_KEY_SIZE) {
+    return REPLAY_KEY;
+  }
+  return REPLAY_END;
+}
+
+double replay_read_tick(replay_t *replay) {
+  assert(replay_next(replay) == REPLAY_TICK);
+  double dt;
+  memcpy(&dt, replay->records + replay->position + 1, sizeof(double));
+  replay->position += REPLAY_TICK_SIZE;
+  replay->ticks++;
+  return dt;
+}
+
+key_event_t replay_read_key(replay_t *replay) {
+  assert(replay_next(replay) == REPLAY_KEY);
+  uint8_t *record = replay->records + replay->position;
+  key_event_t event = {.key = record[1], .type = record[2]};
+  memcpy(&event.held_time, record + 3, sizeof(double));
+  replay->position += REPLAY_KEY_SIZE;
+  return event;
+}
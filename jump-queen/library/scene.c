@@ -1,33 +1,137 @@
 #include "stdio.h"
 #include "stdlib.h"
+#include "string.h"
 
+#include "alloc.h"
+#include "arena.h"
 #include "assert.h"
 #include "body.h"
+#include "math.h"
 #include "forces.h"
+#include "profile.h"
 #include "scene.h"
 
 const size_t BODIES_INTIAL_CAPACITY = 25;
 const size_t FORCE_APPLIERS_INTIAL_CAPACITY = 3;
+// fraction of its bounding radius a body may travel in one substep
+const double SUBSTEP_TRAVEL_FRACTION = 0.5;
+const char SCENE_FILE_MAGIC[4] = {'S', 'C', 'N', 'E'};
+const uint32_t SCENE_FILE_VERSION = 2;
+// written in place of a force creator's body count when it has no body list
+const uint32_t SCENE_FILE_NO_BODIES = UINT32_MAX;
+// slots are read in chunks of this many, growing the slot map as they arrive
+const size_t SCENE_FILE_SLOT_CHUNK = 1024;
+
+// the fixed-size start of a scene file, laid out the same on every platform
+typedef struct scene_header {
+  char magic[4];
+  uint32_t version;
+  uint32_t integrator;
+  uint32_t slot_count;
+  uint32_t free_slot_count;
+  uint32_t body_count;
+  uint32_t aux_count;
+  uint32_t padding;
+  uint64_t max_substeps;
+  double sleep_velocity;
+  double time_to_sleep;
+  double dt;
+} scene_header_t;
 
 typedef struct scene {
   list_t *bodies;
+  // slot map from body handles to bodies; freed slots are reused
+  size_t slot_capacity;
+  size_t slot_count;
+  body_t **slots;
+  uint32_t *generations;
+  size_t free_slot_count;
+  uint32_t *free_slots;
   list_t *force_appliers;
+  double dt;
+  integrator_t integrator;
+  // scratch space for INTEGRATOR_RK4
+  rk4_workspace_t rk4_workspace;
+  // the bodies that move this tick, gathered for the integrator
+  size_t moving_capacity;
+  body_t **moving;
+  // substepping settings (disabled when max_substeps <= 1)
+  size_t max_substeps;
+  // the bodies that need substeps this tick, with their substep counts and
+  // the forces they are held at
+  size_t fast_count;
+  body_t **fast;
+  size_t *fast_substeps;
+  vector_t *fast_forces;
+  // the collisions rerun between substeps
+  size_t rerun_capacity;
+  force_creator_t *rerun_forcers;
+  void **rerun_auxes;
+  list_t **rerun_bodies;
+  // sleeping settings (disabled when time_to_sleep <= 0)
+  double sleep_velocity;
+  double time_to_sleep;
+  // scratch space used to group touching bodies into islands
+  size_t island_capacity;
+  size_t *island_parent;
+  bool *island_ready;
+  bool *island_awake;
 } scene_t;
 
 scene_t *scene_init(void) {
-  scene_t *scene = malloc(sizeof(scene_t));
+  scene_t *scene = engine_malloc(sizeof(scene_t), ALLOC_SCENE);
   scene->bodies = list_init(BODIES_INTIAL_CAPACITY, (free_func_t)body_free);
   assert(scene->bodies != NULL);
+  scene->slot_capacity = 0;
+  scene->slot_count = 0;
+  scene->slots = NULL;
+  scene->generations = NULL;
+  scene->free_slot_count = 0;
+  scene->free_slots = NULL;
   scene->force_appliers = list_init(FORCE_APPLIERS_INTIAL_CAPACITY,
                                     (free_func_t)force_applier_free);
   assert(scene->force_appliers != NULL);
+  scene->dt = 0.0;
+  scene->integrator = INTEGRATOR_AVERAGE_VELOCITY;
+  scene->rk4_workspace = (rk4_workspace_t){0};
+  scene->moving_capacity = 0;
+  scene->moving = NULL;
+  scene->max_substeps = 1;
+  scene->fast_count = 0;
+  scene->fast = NULL;
+  scene->fast_substeps = NULL;
+  scene->fast_forces = NULL;
+  scene->rerun_capacity = 0;
+  scene->rerun_forcers = NULL;
+  scene->rerun_auxes = NULL;
+  scene->rerun_bodies = NULL;
+  scene->sleep_velocity = 0.0;
+  scene->time_to_sleep = 0.0;
+  scene->island_capacity = 0;
+  scene->island_parent = NULL;
+  scene->island_ready = NULL;
+  scene->island_awake = NULL;
   return scene;
 }
 
 void scene_free(scene_t *scene) {
   list_free(scene->bodies);
   list_free(scene->force_appliers);
-  free(scene);
+  engine_free(scene->slots);
+  engine_free(scene->generations);
+  engine_free(scene->free_slots);
+  rk4_workspace_free(&scene->rk4_workspace);
+  engine_free(scene->moving);
+  engine_free(scene->fast);
+  engine_free(scene->fast_substeps);
+  engine_free(scene->fast_forces);
+  engine_free(scene->rerun_forcers);
+  engine_free(scene->rerun_auxes);
+  engine_free(scene->rerun_bodies);
+  engine_free(scene->island_parent);
+  engine_free(scene->island_ready);
+  engine_free(scene->island_awake);
+  engine_free(scene);
 }
 
 size_t scene_bodies(scene_t *scene) { return list_size(scene->bodies); }
@@ -36,18 +140,88 @@ body_t *scene_get_body(scene_t *scene, size_t index) {
   return list_get(scene->bodies, index);
 }
 
-void scene_add_body(scene_t *scene, body_t *body) {
+void scene_reserve_slots(scene_t *scene, size_t count) {
+  if (count <= scene->slot_capacity) {
+    return;
+  }
+  scene->slot_capacity = 2 * count;
+  scene->slots = engine_realloc(
+      scene->slots, scene->slot_capacity * sizeof(body_t *), ALLOC_SCENE);
+  scene->generations = engine_realloc(
+      scene->generations, scene->slot_capacity * sizeof(uint32_t), ALLOC_SCENE);
+  scene->free_slots = engine_realloc(
+      scene->free_slots, scene->slot_capacity * sizeof(uint32_t), ALLOC_SCENE);
+  assert(scene->slots != NULL && scene->generations != NULL &&
+         scene->free_slots != NULL);
+}
+
+body_handle_t scene_add_body(scene_t *scene, body_t *body) {
   list_add(scene->bodies, body);
+  body_mark_static_changed(body);
+  uint32_t index;
+  if (scene->free_slot_count > 0) {
+    index = scene->free_slots[--scene->free_slot_count];
+  } else {
+    scene_reserve_slots(scene, scene->slot_count + 1);
+    index = scene->slot_count++;
+    scene->generations[index] = 1;
+  }
+  scene->slots[index] = body;
+  body_handle_t handle = {index, scene->generations[index]};
+  body_set_handle(body, handle);
+  return handle;
+}
+
+// invalidates the body's handle and lets its slot be reused
+void scene_release_slot(scene_t *scene, body_t *body) {
+  body_handle_t handle = body_get_handle(body);
+  if (handle.generation == 0 || handle.index >= scene->slot_count ||
+      scene->slots[handle.index] != body) {
+    return;
+  }
+  scene->slots[handle.index] = NULL;
+  scene->generations[handle.index]++;
+  if (scene->generations[handle.index] == 0) {
+    scene->generations[handle.index] = 1;
+  }
+  scene->free_slots[scene->free_slot_count++] = handle.index;
+  body_set_handle(body, BODY_HANDLE_NULL);
+}
+
+body_t *scene_resolve(scene_t *scene, body_handle_t handle) {
+  if (handle.index >= scene->slot_count ||
+      scene->generations[handle.index] != handle.generation) {
+    return NULL;
+  }
+  body_t *body = scene->slots[handle.index];
+  if (body == NULL || body_is_removed(body)) {
+    return NULL;
+  }
+  return body;
+}
+
+bool scene_handle_valid(scene_t *scene, body_handle_t handle) {
+  return scene_resolve(scene, handle) != NULL;
+}
+
+void scene_remove_handle(scene_t *scene, body_handle_t handle) {
+  body_t *body = scene_resolve(scene, handle);
+  if (body != NULL) {
+    body_remove(body);
+  }
 }
 
 void scene_remove_body(scene_t *scene, size_t index) {
-  body_remove(list_remove(scene->bodies, index));
+  body_t *body = list_remove(scene->bodies, index);
+  scene_release_slot(scene, body);
+  body_mark_static_changed(body);
+  body_remove(body);
 }
 
 void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
                              free_func_t freer) {
-  scene_add_bodies_force_creator(scene, forcer, aux, aux_get_bodies(aux, freer),
-                                 freer);
+  // aux may be any struct, so the bodies are unknown
+  scene_add_bodies_force_creator(scene, forcer, aux, NULL, freer);
 }
 
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
@@ -58,27 +232,354 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
     force_applier_t *applier =
         (force_applier_t *)list_get(scene->force_appliers, i);
     if (force_applier_get_force_creator(applier) == forcer) {
-      force_applier_add_aux(applier, aux);
+      force_applier_add_aux(applier, aux, bodies);
       forcer_already_exists = 1;
       break;
     }
   }
   if (!forcer_already_exists) {
     force_applier_t *new_applier = force_applier_init(forcer, freer);
-    force_applier_add_aux(new_applier, aux);
+    force_applier_add_aux(new_applier, aux, bodies);
     list_add(scene->force_appliers, new_applier);
   }
 }
 
+double scene_get_dt(scene_t *scene) { return scene->dt; }
+
+void scene_set_integrator(scene_t *scene, integrator_t integrator) {
+  scene->integrator = integrator;
+}
+
+void scene_set_substepping(scene_t *scene, size_t max_substeps) {
+  scene->max_substeps = max_substeps;
+}
+
+bool scene_sleep_enabled(scene_t *scene) { return scene->time_to_sleep > 0; }
+
+void scene_set_sleep(scene_t *scene, double velocity_threshold,
+                     double time_to_sleep) {
+  scene->sleep_velocity = velocity_threshold;
+  scene->time_to_sleep = time_to_sleep;
+  if (!scene_sleep_enabled(scene)) {
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+      body_wake(scene_get_body(scene, i));
+    }
+  }
+}
+
+// whether every body a force creator depends on is asleep or immovable
+bool bodies_resting(list_t *bodies) {
+  size_t size = list_size(bodies);
+  if (size == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < size; i++) {
+    body_t *body = (body_t *)list_get(bodies, i);
+    if (!body_is_sleeping(body) && !body_is_immovable(body)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool body_is_dynamic(body_t *body) {
+  double mass = body_get_mass(body);
+  return mass != INFINITY && mass != 0;
+}
+
+size_t island_find(size_t *parent, size_t i) {
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+void scene_reserve_islands(scene_t *scene, size_t count) {
+  if (count <= scene->island_capacity) {
+    return;
+  }
+  size_t capacity = 2 * count;
+  scene->island_parent = engine_realloc(
+      scene->island_parent, capacity * sizeof(size_t), ALLOC_SCENE);
+  scene->island_ready =
+      engine_realloc(scene->island_ready, capacity * sizeof(bool), ALLOC_SCENE);
+  scene->island_awake =
+      engine_realloc(scene->island_awake, capacity * sizeof(bool), ALLOC_SCENE);
+  assert(scene->island_parent != NULL && scene->island_ready != NULL &&
+         scene->island_awake != NULL);
+  scene->island_capacity = capacity;
+}
+
+// groups dynamic bodies that are touching into islands (union-find over the
+// contacts recorded by collision force creators), then puts every island
+// whose bodies have all rested long enough, and are still resting after this
+// tick's forces and impulses, to sleep and wakes the rest
+void scene_update_sleep(scene_t *scene) {
+  size_t body_count = scene_bodies(scene);
+  scene_reserve_islands(scene, body_count);
+  size_t *parent = scene->island_parent;
+  for (size_t i = 0; i < body_count; i++) {
+    body_set_island(scene_get_body(scene, i), i);
+    parent[i] = i;
+    scene->island_ready[i] = true;
+    scene->island_awake[i] = false;
+  }
+
+  for (size_t i = 0; i < list_size(scene->force_appliers); i++) {
+    force_applier_t *applier =
+        (force_applier_t *)list_get(scene->force_appliers, i);
+    free_func_t freer = force_applier_get_freer(applier);
+    for (size_t j = 0; j < force_applier_auxes(applier); j++) {
+      void *aux = force_applier_get_aux(applier, j);
+      if (!aux_get_contact(aux, freer)) {
+        continue;
+      }
+      list_t *bodies = force_applier_get_bodies(applier, j);
+      body_t *body1 = (body_t *)list_get(bodies, 0);
+      body_t *body2 = (body_t *)list_get(bodies, 1);
+      // immovable bodies (e.g. the ground) do not join islands together
+      if (!body_is_dynamic(body1) || !body_is_dynamic(body2)) {
+        continue;
+      }
+      size_t root1 = island_find(parent, body_get_island(body1));
+      size_t root2 = island_find(parent, body_get_island(body2));
+      parent[root1] = root2;
+    }
+  }
+
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (!body_is_dynamic(body)) {
+      continue;
+    }
+    size_t root = island_find(parent, i);
+    if (!body_is_sleeping(body)) {
+      scene->island_awake[root] = true;
+      scene->island_ready[root] =
+          scene->island_ready[root] && body_can_sleep(body) &&
+          body_get_rest_time(body) >= scene->time_to_sleep &&
+          body_is_resting(body, scene->sleep_velocity);
+    }
+  }
+
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (!body_is_dynamic(body)) {
+      continue;
+    }
+    size_t root = island_find(parent, i);
+    if (!scene->island_ready[root]) {
+      body_wake(body);
+    } else if (scene->island_awake[root]) {
+      body_sleep(body);
+    }
+  }
+}
+
+bool bodies_removed(list_t *bodies) {
+  for (size_t k = list_size(bodies) - 1; k != -1; k--) {
+    if (body_is_removed((body_t *)list_get(bodies, k))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// whether the integrator advances every body a force creator depends on this
+// tick; resting and substepped bodies are left alone
+bool bodies_integrated(scene_t *scene, list_t *bodies) {
+  bool sleep_enabled = scene_sleep_enabled(scene);
+  for (size_t i = 0; i < list_size(bodies); i++) {
+    body_t *body = (body_t *)list_get(bodies, i);
+    if (body_is_removed(body)) {
+      return false;
+    }
+    if (sleep_enabled && (body_is_sleeping(body) || body_is_immovable(body))) {
+      return false;
+    }
+    for (size_t f = 0; f < scene->fast_count; f++) {
+      if (scene->fast[f] == body) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Force evaluator for RK4: reruns the force creators that can be resampled.
+// Force creators touching a body outside the integrated set are skipped, so
+// they are held at their first sample like collisions and never add forces
+// to (or wake) bodies nothing resets between the samples.
+void scene_apply_stateless_forces(void *aux) {
+  scene_t *scene = (scene_t *)aux;
+  for (size_t i = 0; i < list_size(scene->force_appliers); i++) {
+    force_applier_t *applier =
+        (force_applier_t *)list_get(scene->force_appliers, i);
+    free_func_t freer = force_applier_get_freer(applier);
+    force_creator_t forcer = force_applier_get_force_creator(applier);
+    for (size_t j = 0; j < force_applier_auxes(applier); j++) {
+      void *aux = force_applier_get_aux(applier, j);
+      if (!aux_is_stateless(freer)) {
+        continue;
+      }
+      if (!bodies_integrated(scene, force_applier_get_bodies(applier, j))) {
+        continue;
+      }
+      forcer(aux);
+    }
+  }
+}
+
+void scene_integrate(scene_t *scene, body_t **bodies, size_t count,
+                     double dt) {
+  switch (scene->integrator) {
+  case INTEGRATOR_SEMI_IMPLICIT_EULER:
+    integrate_semi_implicit_euler(bodies, count, dt);
+    break;
+  case INTEGRATOR_VELOCITY_VERLET:
+    integrate_velocity_verlet(bodies, count, dt);
+    break;
+  case INTEGRATOR_RK4:
+    integrate_rk4(bodies, count, dt, scene_apply_stateless_forces, scene,
+                  &scene->rk4_workspace);
+    break;
+  default:
+    integrate_average_velocity(bodies, count, dt);
+  }
+}
+
+// substeps with forces held constant, so RK4's resampling does not apply
+void scene_integrate_substep(scene_t *scene, body_t *body, double dt) {
+  if (scene->integrator == INTEGRATOR_RK4) {
+    integrate_average_velocity(&body, 1, dt);
+  } else {
+    scene_integrate(scene, &body, 1, dt);
+  }
+}
+
+// how many substeps keep a body from moving more than a fraction of its size
+size_t body_substeps(body_t *body, double dt, size_t max_substeps) {
+  double radius = body_get_radius(body);
+  if (radius == 0) {
+    return 1;
+  }
+  vector_t velocity = body_get_velocity(body);
+  double mass = body_get_mass(body);
+  if (mass != INFINITY && mass != 0) {
+    velocity =
+        vec_add(velocity, vec_multiply(1 / mass, body_get_impulse(body)));
+  }
+  double substeps = ceil(sqrt(vec_dot(velocity, velocity)) * dt /
+                         (SUBSTEP_TRAVEL_FRACTION * radius));
+  if (substeps <= 1) {
+    return 1;
+  }
+  return substeps > max_substeps ? max_substeps : (size_t)substeps;
+}
+
+void scene_reserve_reruns(scene_t *scene, size_t count) {
+  if (count <= scene->rerun_capacity) {
+    return;
+  }
+  scene->rerun_capacity = 2 * count;
+  scene->rerun_forcers = engine_realloc(
+      scene->rerun_forcers, scene->rerun_capacity * sizeof(force_creator_t),
+      ALLOC_SCENE);
+  scene->rerun_auxes = engine_realloc(
+      scene->rerun_auxes, scene->rerun_capacity * sizeof(void *), ALLOC_SCENE);
+  scene->rerun_bodies = engine_realloc(
+      scene->rerun_bodies, scene->rerun_capacity * sizeof(list_t *),
+      ALLOC_SCENE);
+  assert(scene->rerun_forcers != NULL && scene->rerun_auxes != NULL &&
+         scene->rerun_bodies != NULL);
+}
+
+// gathers the collisions involving any of the fast bodies
+size_t scene_gather_reruns(scene_t *scene, size_t fast) {
+  size_t reruns = 0;
+  for (size_t i = 0; i < list_size(scene->force_appliers); i++) {
+    force_applier_t *applier =
+        (force_applier_t *)list_get(scene->force_appliers, i);
+    free_func_t freer = force_applier_get_freer(applier);
+    for (size_t j = 0; j < force_applier_auxes(applier); j++) {
+      void *aux = force_applier_get_aux(applier, j);
+      if (!aux_is_collision(freer)) {
+        continue;
+      }
+      list_t *bodies = force_applier_get_bodies(applier, j);
+      bool involved = false;
+      for (size_t k = 0; k < list_size(bodies) && !involved; k++) {
+        body_t *body = (body_t *)list_get(bodies, k);
+        for (size_t f = 0; f < fast && !involved; f++) {
+          involved = scene->fast[f] == body;
+        }
+      }
+      if (involved) {
+        scene_reserve_reruns(scene, reruns + 1);
+        scene->rerun_forcers[reruns] = force_applier_get_force_creator(applier);
+        scene->rerun_auxes[reruns] = aux;
+        scene->rerun_bodies[reruns] = bodies;
+        reruns++;
+      }
+    }
+  }
+  return reruns;
+}
+
+// Advances each fast body through its own number of substeps. The substeps
+// of all fast bodies are interleaved so their collisions can be rerun in
+// between; impulses from those collisions on slow bodies apply next tick.
+void scene_substep(scene_t *scene, size_t fast, double dt) {
+  size_t reruns = scene_gather_reruns(scene, fast);
+  size_t most_substeps = 1;
+  for (size_t i = 0; i < fast; i++) {
+    scene->fast_forces[i] = body_get_force(scene->fast[i]);
+    if (scene->fast_substeps[i] > most_substeps) {
+      most_substeps = scene->fast_substeps[i];
+    }
+  }
+  for (size_t step = 0; step < most_substeps; step++) {
+    for (size_t i = 0; i < fast; i++) {
+      body_t *body = scene->fast[i];
+      size_t substeps = scene->fast_substeps[i];
+      // spreads this body's substeps evenly over the most_substeps rounds
+      if ((step + 1) * substeps / most_substeps ==
+              step * substeps / most_substeps ||
+          body_is_removed(body)) {
+        continue;
+      }
+      if (step * substeps / most_substeps > 0) {
+        body_add_force(body, scene->fast_forces[i]);
+      }
+      scene_integrate_substep(scene, body, dt / substeps);
+    }
+    if (step + 1 == most_substeps) {
+      break;
+    }
+    for (size_t i = 0; i < reruns; i++) {
+      if (!bodies_removed(scene->rerun_bodies[i])) {
+        scene->rerun_forcers[i](scene->rerun_auxes[i]);
+      }
+    }
+  }
+}
+
 void scene_tick(scene_t *scene, double dt) {
+  // a new frame: nothing from the last one may still be in the frame arena
+  arena_reset(frame_arena());
+  PROFILE_BEGIN(PROFILE_TICK);
+  scene->dt = dt;
+  bool sleep_enabled = scene_sleep_enabled(scene);
   // run through every force_applier to apply forces and impulses
+  PROFILE_BEGIN(PROFILE_FORCES);
   for (size_t i = list_size(scene->force_appliers) - 1; i != -1; i--) {
     force_applier_t *applier =
         (force_applier_t *)list_get(scene->force_appliers, i);
     force_creator_t forcer = force_applier_get_force_creator(applier);
     for (size_t j = force_applier_auxes(applier) - 1; j != -1; j--) {
       void *aux = force_applier_get_aux(applier, j);
-      list_t *bodies = aux_get_bodies(aux, force_applier_get_freer(applier));
+      list_t *bodies = force_applier_get_bodies(applier, j);
       if (bodies == NULL) {
         forcer(aux);
         continue;
@@ -95,17 +596,21 @@ void scene_tick(scene_t *scene, double dt) {
       if (removed) {
         continue;
       }
+      if (sleep_enabled && bodies_resting(bodies)) {
+        continue;
+      }
       forcer(aux);
     }
   }
+  PROFILE_END(PROFILE_FORCES);
 
   // run through again to remove every aux with a body marked for removal
+  PROFILE_BEGIN(PROFILE_REMOVAL);
   for (size_t i = list_size(scene->force_appliers) - 1; i != -1; i--) {
     force_applier_t *applier =
         (force_applier_t *)list_get(scene->force_appliers, i);
     for (size_t j = force_applier_auxes(applier) - 1; j != -1; j--) {
-      list_t *bodies = aux_get_bodies(force_applier_get_aux(applier, j),
-                                      force_applier_get_freer(applier));
+      list_t *bodies = force_applier_get_bodies(applier, j);
       if (bodies == NULL) {
         continue;
       }
@@ -119,14 +624,265 @@ void scene_tick(scene_t *scene, double dt) {
     }
   }
 
+  if (sleep_enabled) {
+    scene_update_sleep(scene);
+  }
+
   // removes from scene and frees all bodies marked for removal
-  // and ticks all other bodies in scene
+  // and gathers all other moving bodies in scene to be integrated
+  if (scene->moving_capacity < scene_bodies(scene)) {
+    scene->moving_capacity = 2 * scene_bodies(scene);
+    size_t capacity = scene->moving_capacity;
+    scene->moving =
+        engine_realloc(scene->moving, capacity * sizeof(body_t *), ALLOC_SCENE);
+    scene->fast =
+        engine_realloc(scene->fast, capacity * sizeof(body_t *), ALLOC_SCENE);
+    scene->fast_substeps = engine_realloc(
+        scene->fast_substeps, capacity * sizeof(size_t), ALLOC_SCENE);
+    scene->fast_forces = engine_realloc(
+        scene->fast_forces, capacity * sizeof(vector_t), ALLOC_SCENE);
+    assert(scene->moving != NULL && scene->fast != NULL &&
+           scene->fast_substeps != NULL && scene->fast_forces != NULL);
+  }
+  size_t moving = 0;
+  size_t fast = 0;
+  // compacts the surviving bodies in one pass instead of shifting the list
+  // once per removed body
+  size_t kept = 0;
   for (size_t i = 0; i < scene_bodies(scene); i++) {
     body_t *body = (body_t *)list_get(scene->bodies, i);
     if (body_is_removed(body)) {
-      body_free((body_t *)list_remove(scene->bodies, i));
+      scene_release_slot(scene, body);
+      body_free(body);
+      continue;
+    }
+    list_set(scene->bodies, kept++, body);
+    if (sleep_enabled && (body_is_sleeping(body) || body_is_immovable(body))) {
+      body_reset_force_and_impulse(body);
     } else {
-      body_tick(body, dt);
+      size_t substeps = scene->max_substeps > 1
+                            ? body_substeps(body, dt, scene->max_substeps)
+                            : 1;
+      if (substeps > 1) {
+        scene->fast_substeps[fast] = substeps;
+        scene->fast[fast++] = body;
+      } else {
+        scene->moving[moving++] = body;
+      }
+    }
+  }
+  list_truncate(scene->bodies, kept);
+  PROFILE_END(PROFILE_REMOVAL);
+  PROFILE_BEGIN(PROFILE_INTEGRATE);
+  scene->fast_count = fast;
+  scene_integrate(scene, scene->moving, moving, dt);
+  if (fast > 0) {
+    scene_substep(scene, fast, dt);
+  }
+  if (sleep_enabled) {
+    for (size_t i = 0; i < moving; i++) {
+      body_update_rest_time(scene->moving[i], dt, scene->sleep_velocity);
+    }
+    for (size_t i = 0; i < fast; i++) {
+      body_update_rest_time(scene->fast[i], dt, scene->sleep_velocity);
     }
   }
-}
\ No newline at end of file
+  PROFILE_END(PROFILE_INTEGRATE);
+  PROFILE_END(PROFILE_TICK);
+}
+
+bool scene_save(scene_t *scene, FILE *file, const info_codec_t *codec) {
+  size_t body_count = scene_bodies(scene);
+  size_t aux_count = 0;
+  for (size_t i = 0; i < list_size(scene->force_appliers); i++) {
+    aux_count += force_applier_auxes(list_get(scene->force_appliers, i));
+  }
+  // zeroed so no uninitialized bytes are written
+  scene_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SCENE_FILE_MAGIC, sizeof(header.magic));
+  header.version = SCENE_FILE_VERSION;
+  header.integrator = scene->integrator;
+  header.slot_count = scene->slot_count;
+  header.free_slot_count = scene->free_slot_count;
+  header.body_count = body_count;
+  header.aux_count = aux_count;
+  header.max_substeps = scene->max_substeps;
+  header.sleep_velocity = scene->sleep_velocity;
+  header.time_to_sleep = scene->time_to_sleep;
+  header.dt = scene->dt;
+  if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+      fwrite(scene->generations, sizeof(uint32_t), scene->slot_count, file) !=
+          scene->slot_count ||
+      fwrite(scene->free_slots, sizeof(uint32_t), scene->free_slot_count,
+             file) != scene->free_slot_count) {
+    return false;
+  }
+
+  // force creators refer to their bodies by position in the body list
+  uint32_t *positions =
+      engine_malloc(scene->slot_count * sizeof(uint32_t), ALLOC_SCENE);
+  assert(scene->slot_count == 0 || positions != NULL);
+  bool written = true;
+  for (size_t i = 0; written && i < body_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    assert(body_get_handle(body).index < scene->slot_count);
+    positions[body_get_handle(body).index] = i;
+    written = body_save(body, file) &&
+              (codec == NULL || codec->save(body_get_info(body), file));
+  }
+
+  for (size_t i = 0; written && i < list_size(scene->force_appliers); i++) {
+    force_applier_t *applier = list_get(scene->force_appliers, i);
+    force_creator_t forcer = force_applier_get_force_creator(applier);
+    for (size_t j = 0; written && j < force_applier_auxes(applier); j++) {
+      void *aux = force_applier_get_aux(applier, j);
+      list_t *bodies = force_applier_get_bodies(applier, j);
+      uint32_t count = bodies == NULL ? SCENE_FILE_NO_BODIES
+                                      : (uint32_t)list_size(bodies);
+      written = fwrite(&count, sizeof(uint32_t), 1, file) == 1;
+      for (size_t k = 0; written && bodies != NULL && k < count; k++) {
+        body_t *body = list_get(bodies, k);
+        body_handle_t handle = body_get_handle(body);
+        assert(handle.index < scene->slot_count &&
+               scene->slots[handle.index] == body);
+        written = fwrite(&positions[handle.index], sizeof(uint32_t), 1,
+                         file) == 1;
+      }
+      written = written && force_kind_save(forcer, aux, file);
+    }
+  }
+  engine_free(positions);
+  return written;
+}
+
+// reads the bodies of a force creator, which must already be in the scene
+bool scene_load_force_bodies(scene_t *scene, FILE *file, list_t **bodies) {
+  uint32_t count;
+  if (fread(&count, sizeof(uint32_t), 1, file) != 1) {
+    return false;
+  }
+  if (count == SCENE_FILE_NO_BODIES) {
+    *bodies = NULL;
+    return true;
+  }
+  // the list grows as positions are read, in case count is corrupt
+  size_t capacity = count < scene_bodies(scene) ? count : scene_bodies(scene);
+  *bodies = list_init(capacity, NULL);
+  for (size_t i = 0; i < count; i++) {
+    uint32_t position;
+    if (fread(&position, sizeof(uint32_t), 1, file) != 1 ||
+        position >= scene_bodies(scene)) {
+      list_free(*bodies);
+      return false;
+    }
+    list_add(*bodies, scene_get_body(scene, position));
+  }
+  return true;
+}
+
+/**
+ * Reads the generations of a scene's slots, which start out empty.
+ * The slot map only grows as the generations are read, so a corrupt count
+ * runs into the end of the file instead of an enormous allocation.
+ */
+bool scene_load_slots(scene_t *scene, FILE *file, size_t count) {
+  while (scene->slot_count < count) {
+    size_t chunk = count - scene->slot_count;
+    if (chunk > SCENE_FILE_SLOT_CHUNK) {
+      chunk = SCENE_FILE_SLOT_CHUNK;
+    }
+    scene_reserve_slots(scene, scene->slot_count + chunk);
+    if (fread(scene->generations + scene->slot_count, sizeof(uint32_t), chunk,
+              file) != chunk) {
+      return false;
+    }
+    for (size_t i = 0; i < chunk; i++) {
+      scene->slots[scene->slot_count++] = NULL;
+    }
+  }
+  return true;
+}
+
+/**
+ * Checks that the free slots read from a file are distinct slots
+ * which none of the loaded bodies hold, so scene_add_body() can reuse them.
+ */
+bool scene_free_slots_valid(scene_t *scene) {
+  bool *listed = engine_malloc(scene->slot_count * sizeof(bool), ALLOC_SCENE);
+  assert(scene->slot_count == 0 || listed != NULL);
+  memset(listed, 0, scene->slot_count * sizeof(bool));
+  bool valid = true;
+  for (size_t i = 0; valid && i < scene->free_slot_count; i++) {
+    uint32_t index = scene->free_slots[i];
+    valid = index < scene->slot_count && !listed[index] &&
+            scene->slots[index] == NULL;
+    if (valid) {
+      listed[index] = true;
+    }
+  }
+  engine_free(listed);
+  return valid;
+}
+
+scene_t *scene_load(FILE *file, const info_codec_t *codec, void *context) {
+  scene_header_t header;
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      memcmp(header.magic, SCENE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != SCENE_FILE_VERSION ||
+      header.integrator > INTEGRATOR_RK4 ||
+      header.free_slot_count > header.slot_count) {
+    return NULL;
+  }
+  scene_t *scene = scene_init();
+  scene->integrator = header.integrator;
+  scene->max_substeps = header.max_substeps;
+  scene->sleep_velocity = header.sleep_velocity;
+  scene->time_to_sleep = header.time_to_sleep;
+  scene->dt = header.dt;
+  bool read = scene_load_slots(scene, file, header.slot_count);
+  // there is room for the free slots once every slot has been read
+  scene->free_slot_count = read ? header.free_slot_count : 0;
+  read = read && fread(scene->free_slots, sizeof(uint32_t),
+                       scene->free_slot_count,
+                       file) == scene->free_slot_count;
+
+  for (size_t i = 0; read && i < header.body_count; i++) {
+    body_t *body = body_load(file);
+    if (body == NULL) {
+      read = false;
+      break;
+    }
+    list_add(scene->bodies, body);
+    body_mark_static_changed(body);
+    body_handle_t handle = body_get_handle(body);
+    read = handle.index < scene->slot_count &&
+           scene->slots[handle.index] == NULL &&
+           scene->generations[handle.index] == handle.generation;
+    if (read) {
+      scene->slots[handle.index] = body;
+    }
+    void *info;
+    if (read && codec != NULL && (read = codec->load(file, context, &info))) {
+      body_set_info(body, info, codec->freer);
+    }
+  }
+
+  read = read && scene_free_slots_valid(scene);
+
+  for (size_t i = 0; read && i < header.aux_count; i++) {
+    list_t *bodies;
+    read = scene_load_force_bodies(scene, file, &bodies);
+    if (read && !force_kind_load(file, scene, bodies, context)) {
+      if (bodies != NULL) {
+        list_free(bodies);
+      }
+      read = false;
+    }
+  }
+  if (!read) {
+    scene_free(scene);
+    return NULL;
+  }
+  return scene;
+}
@@ -1,12 +1,25 @@
 #include "sdl_wrapper.h"
+#include "arena.h"
+#include "capture.h"
+#include "profile.h"
+#include "raster.h"
+#include "replay.h"
 #include "vector.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL2_gfxPrimitives.h>
 //#include <SDL2/SDL_mixer.h>
 #include <assert.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#ifdef RENDER_THREAD
+#include <pthread.h>
+#if !SDL_VERSION_ATLEAST(2, 0, 18)
+#error "RENDER_THREAD draws snapshots with SDL_RenderGeometry (SDL 2.0.18+)"
+#endif
+#endif
 
 const char WINDOW_TITLE[] = "~Jump Queen~";
 const double SIZE_FACTOR = 1;
@@ -15,6 +28,20 @@ const int WINDOW_HEIGHT = 600 * SIZE_FACTOR;
 const vector_t WINDOW_DIM = {WINDOW_WIDTH, WINDOW_HEIGHT};
 const vector_t WINDOW_CENTER = {WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2};
 const double MS_PER_S = 1e3;
+// Environment variables that configure recording and headless runs
+const char CAPTURE_VARIABLE[] = "CAPTURE";
+const char CAPTURE_FRAMES_VARIABLE[] = "CAPTURE_FRAMES";
+const char HEADLESS_VARIABLE[] = "HEADLESS";
+const char RENDERER_VARIABLE[] = "RENDERER";
+const char REPLAY_VARIABLE[] = "REPLAY";
+const char REPLAY_RECORD_VARIABLE[] = "REPLAY_RECORD";
+const char SOFTWARE_RENDERER[] = "software";
+const uint32_t SOFTWARE_BACKGROUND = 0xffffffff;
+const uint32_t SOFTWARE_BOUNDARY = 0xff000000;
+const size_t CAPTURE_QUEUE_LENGTH = 8;
+const double CAPTURE_FPS = 60;
+#define KEY_EVENT_CAPACITY 64
+#define KEY_COUNT 128
 
 /**
  * The coordinate at the center of the screen.
@@ -24,6 +51,10 @@ vector_t center;
  * The coordinate difference from the center to the top right corner.
  */
 vector_t max_diff;
+/**
+ * How far the view has been moved from center, in scene coordinates.
+ */
+vector_t camera = {0, 0};
 /**
  * The SDL window where the scene is rendered.
  */
@@ -32,10 +63,47 @@ SDL_Window *window;
  * The renderer used to draw the scene.
  */
 SDL_Renderer *renderer;
+/**
+ * The framebuffer drawn to by the software renderer, or NULL if SDL draws.
+ */
+raster_t *raster = NULL;
+/**
+ * A way of drawing frames. sdl_clear(), sdl_draw_polygon(), sdl_show() and
+ * sdl_render_scene() do the work common to every renderer and call into
+ * the backend chosen by sdl_init() for the rest.
+ */
+typedef struct {
+  /** Gets the size of the frame in pixels */
+  void (*get_size)(int *width, int *height);
+  /** Fills the frame with the background color */
+  void (*clear)(void);
+  /** Fills a polygon given in scene coordinates */
+  void (*draw_polygon)(list_t *points, rgb_color_t color);
+  /** Draws the outline of a rectangle given in pixel coordinates */
+  void (*draw_outline)(int x, int y, int width, int height);
+  /** Copies the frame drawn so far out as RGB triples */
+  void (*read_rgb)(uint8_t *rgb, int width, int height);
+  /** Displays the finished frame */
+  void (*present)(void);
+  /** Draws every body of a scene as a full frame */
+  void (*render_scene)(scene_t *scene);
+} renderer_backend_t;
+extern const renderer_backend_t sdl_backend, software_backend;
+const renderer_backend_t *backend = &sdl_backend;
 /**
  * The keypress handler, or NULL if none has been configured.
  */
 key_handler_t key_handler = NULL;
+/**
+ * The key events collected by the last sdl_is_done() call, oldest first.
+ * Events past KEY_EVENT_CAPACITY in one frame are only seen by the handler.
+ */
+key_event_t key_events[KEY_EVENT_CAPACITY];
+size_t key_event_count = 0;
+/**
+ * One bit per key value, set while the key is held down.
+ */
+uint64_t keys_down[KEY_COUNT / 64];
 /**
  * SDL's timestamp when a key was last pressed or released.
  * Used to mesasure how long a key has been held.
@@ -46,16 +114,131 @@ uint32_t key_start_timestamp;
  * Initially 0.
  */
 clock_t last_clock = 0;
+/**
+ * The recording of every frame shown, or NULL if frames are not captured.
+ * capture_limit is the number of frames after which sdl_is_done() reports
+ * that the window was closed, or 0 to run until it actually is.
+ */
+capture_t *capture = NULL;
+size_t capture_width, capture_height;
+size_t frames_shown = 0;
+size_t capture_limit = 0;
+/**
+ * The log being recorded or played back, or NULL if there is none.
+ * replay_started is set once the environment has been checked for one,
+ * and random_seed is then the seed the demo should use.
+ */
+replay_t *replay = NULL;
+bool replaying = false;
+bool replay_started = false;
+uint64_t random_seed;
+uint64_t replay_start_counter;
+/**
+ * The scene-to-pixel transform: pixel = offset + (scale, -scale) * scene.
+ * Recomputed by update_transform() once per frame and on resize,
+ * so mapping a vertex takes no divisions or window queries.
+ */
+double pixel_scale;
+vector_t pixel_offset;
+/**
+ * The corners of the part of the scene visible in the window,
+ * which can be larger than the scene itself if the aspect ratios differ.
+ */
+vector_t visible_min;
+vector_t visible_max;
+
+/**
+ * The bodies that never move, drawn once into a window-sized texture that is
+ * copied under the moving bodies each frame. It is only redrawn when the scene,
+ * body_static_version() or the transform differ from what it was drawn with.
+ */
+SDL_Texture *static_layer = NULL;
+int static_layer_width, static_layer_height;
+scene_t *static_layer_scene = NULL;
+size_t static_layer_version;
+double static_layer_scale;
+vector_t static_layer_offset;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+/**
+ * The triangles of every body drawn this frame, submitted to SDL at once.
+ * Kept between frames so they only need to grow.
+ */
+SDL_Vertex *batch_vertices = NULL;
+int *batch_indices = NULL;
+size_t batch_vertex_capacity = 0;
+size_t batch_index_capacity = 0;
+#endif
+
+#ifdef RENDER_THREAD
+/**
+ * A body as it was when a snapshot was taken.
+ * Its vertices are points[first_point, first_point + point_count)
+ * of the snapshot that contains it.
+ */
+typedef struct {
+  vector_t centroid;
+  double radius;
+  rgb_color_t color;
+  size_t first_point;
+  size_t point_count;
+} snapshot_body_t;
+
+/**
+ * Everything the render thread needs to draw one simulated frame.
+ * A snapshot owns copies of the bodies' vertices, so the simulation can keep
+ * changing or freeing bodies while an older snapshot is being drawn.
+ */
+typedef struct {
+  snapshot_body_t *bodies;
+  size_t body_count;
+  size_t body_capacity;
+  vector_t *points;
+  size_t point_count;
+  size_t point_capacity;
+  vector_t camera;
+} snapshot_t;
+
+/**
+ * A triple buffer of snapshots. The simulation fills snapshots[write_index]
+ * and swaps it with ready_index; the render thread swaps ready_index with
+ * read_index whenever snapshot_fresh is set. Neither thread ever waits for the
+ * other to finish a frame, only for the lock around the index swaps.
+ */
+snapshot_t snapshots[3];
+size_t write_index = 0, ready_index = 1, read_index = 2;
+bool snapshot_fresh = false;
+pthread_mutex_t snapshot_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Key events polled by the render thread that the simulation thread has not
+ * collected yet, oldest first, whether the window was closed, and whether
+ * sdl_is_done() has told the simulation to stop.
+ */
+key_event_t key_queue[KEY_EVENT_CAPACITY];
+size_t key_queue_count = 0;
+bool quit_requested = false;
+bool simulation_finished = false;
+pthread_mutex_t event_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * The camera offset set by the simulation, applied by the render thread
+ * once a snapshot taken with it is drawn.
+ */
+vector_t next_camera = {0, 0};
+
+/**
+ * The value of SDL_GetPerformanceCounter() when time_since_last_tick() was
+ * last called. clock() counts CPU time of every thread, so it would run fast.
+ */
+uint64_t last_counter = 0;
+#endif
 
 /** Computes the center of the window in pixel coordinates */
 vector_t get_window_center(void) {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width != NULL);
-  assert(height != NULL);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
+  int width, height;
+  backend->get_size(&width, &height);
+  vector_t dimensions = {.x = width, .y = height};
   return vec_multiply(0.5, dimensions);
 }
 
@@ -71,19 +254,58 @@ double get_scene_scale(vector_t window_center) {
   return x_scale < y_scale ? x_scale : y_scale;
 }
 
-/** Maps a scene coordinate to a window coordinate */
-vector_t get_window_position(vector_t scene_pos, vector_t window_center) {
+/** Recomputes the cached scene-to-pixel transform for the window's size */
+void update_transform(void) {
   // Scale scene coordinates by the scaling factor
   // and map the center of the scene to the center of the window
-  vector_t scene_center_offset = vec_subtract(scene_pos, center);
-  double scale = get_scene_scale(window_center);
-  vector_t pixel_center_offset = vec_multiply(scale, scene_center_offset);
-  vector_t pixel = {.x = round(window_center.x + pixel_center_offset.x),
-                    // Flip y axis since positive y is down on the screen
-                    .y = round(window_center.y - pixel_center_offset.y)};
+  vector_t window_center = get_window_center();
+  vector_t view_center = vec_add(center, camera);
+  pixel_scale = get_scene_scale(window_center);
+  // Flip y axis since positive y is down on the screen
+  pixel_offset = (vector_t){.x = window_center.x - pixel_scale * view_center.x,
+                            .y = window_center.y + pixel_scale * view_center.y};
+  vector_t visible_diff = vec_multiply(1 / pixel_scale, window_center);
+  visible_min = vec_subtract(view_center, visible_diff);
+  visible_max = vec_add(view_center, visible_diff);
+}
+
+/**
+ * Checks whether any part of a circle could be in the window,
+ * using the square around it.
+ */
+bool is_visible(vector_t centroid, double radius) {
+  return centroid.x + radius >= visible_min.x &&
+         centroid.x - radius <= visible_max.x &&
+         centroid.y + radius >= visible_min.y &&
+         centroid.y - radius <= visible_max.y;
+}
+
+/**
+ * Checks whether any part of a body could be in the window, using its
+ * bounding circle so no vertex needs to be looked at.
+ */
+bool body_is_visible(body_t *body) {
+  return is_visible(body_get_centroid(body), body_get_radius(body));
+}
+
+/** Maps a scene coordinate to a window coordinate */
+vector_t get_window_position(vector_t scene_pos) {
+  vector_t pixel = {.x = round(pixel_offset.x + pixel_scale * scene_pos.x),
+                    .y = round(pixel_offset.y - pixel_scale * scene_pos.y)};
   return pixel;
 }
 
+/** Maps every vertex of a polygon to window coordinates */
+void get_window_positions(list_t *points, int16_t *x_points,
+                          int16_t *y_points) {
+  size_t n = list_size(points);
+  for (size_t i = 0; i < n; i++) {
+    vector_t *vertex = list_get(points, i);
+    x_points[i] = round(pixel_offset.x + pixel_scale * vertex->x);
+    y_points[i] = round(pixel_offset.y - pixel_scale * vertex->y);
+  }
+}
+
 /**
  * Converts an SDL key code to a char.
  * 7-bit ASCII characters are just returned
@@ -125,6 +347,98 @@ char get_keycode(SDL_Keycode key) {
   }
 }
 
+/** Writes out the remaining captured frames; registered with atexit() */
+void stop_capture(void) {
+  if (capture != NULL) {
+    capture_free(capture);
+    capture = NULL;
+  }
+}
+
+/**
+ * Starts capturing if the CAPTURE environment variable names a destination
+ * (see capture_init()), stopping after CAPTURE_FRAMES frames if that is set.
+ */
+void start_capture(void) {
+  const char *destination = getenv(CAPTURE_VARIABLE);
+  if (destination == NULL || destination[0] == '\0') {
+    return;
+  }
+  int width, height;
+  backend->get_size(&width, &height);
+  capture_width = width;
+  capture_height = height;
+  capture = capture_init(destination, capture_width, capture_height,
+                         CAPTURE_QUEUE_LENGTH);
+  const char *limit = getenv(CAPTURE_FRAMES_VARIABLE);
+  if (limit != NULL) {
+    capture_limit = strtoul(limit, NULL, 10);
+  }
+  atexit(stop_capture);
+}
+
+/** Finishes the log; registered with atexit() */
+void stop_replay(void) {
+  if (replay == NULL) {
+    return;
+  }
+  if (replaying) {
+    double seconds = (double)(SDL_GetPerformanceCounter() -
+                              replay_start_counter) /
+                     SDL_GetPerformanceFrequency();
+    printf("Replayed %zu ticks in %.3f s\n", replay_ticks(replay), seconds);
+  }
+  replay_close(replay);
+  replay = NULL;
+}
+
+/**
+ * Chooses the random seed, and starts playing back the log named by the
+ * REPLAY environment variable or recording to the one named by REPLAY_RECORD.
+ * Only does anything the first time it is called.
+ */
+void start_replay(void) {
+  if (replay_started) {
+    return;
+  }
+  replay_started = true;
+  replay_start_counter = SDL_GetPerformanceCounter();
+  const char *path = getenv(REPLAY_VARIABLE);
+  if (path != NULL && path[0] != '\0') {
+    replay = replay_play(path);
+    if (replay == NULL) {
+      fprintf(stderr, "Could not read the replay log %s\n", path);
+    }
+    assert(replay != NULL);
+    replaying = true;
+    random_seed = replay_seed(replay);
+  } else {
+    random_seed = time(NULL);
+    path = getenv(REPLAY_RECORD_VARIABLE);
+    if (path != NULL && path[0] != '\0') {
+      replay = replay_record(path, random_seed);
+    }
+  }
+  if (replay != NULL) {
+    atexit(stop_replay);
+  }
+}
+
+uint64_t sdl_random_seed(void) {
+  start_replay();
+  return random_seed;
+}
+
+/** Copies the frame being drawn into the capture, if there is room for it */
+void capture_shown_frame(void) {
+  uint8_t *pixels = capture_next_frame(capture);
+  if (pixels == NULL) {
+    return;
+  }
+  backend->read_rgb(pixels, capture_width, capture_height);
+  capture_submit(capture);
+}
+
 void sdl_init(vector_t min, vector_t max) {
   // Check parameters
   assert(min.x < max.x);
@@ -132,14 +446,40 @@ void sdl_init(vector_t min, vector_t max) {
 
   center = vec_multiply(0.5, vec_add(min, max));
   max_diff = vec_subtract(max, center);
+  start_replay();
+#ifdef PROFILE
+  profile_start();
+#endif
+#ifndef RENDER_THREAD
+  // The software renderer never opens a window, so it needs no display
+  const char *renderer_name = getenv(RENDERER_VARIABLE);
+  if (renderer_name != NULL && strcmp(renderer_name, SOFTWARE_RENDERER) == 0) {
+    SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER);
+    raster = raster_init(WINDOW_WIDTH, WINDOW_HEIGHT);
+    backend = &software_backend;
+    update_transform();
+    start_capture();
+    return;
+  }
+#endif
+  // Headless runs draw with the software renderer into a hidden window
+  // of SDL's dummy video driver, so no display is needed
+  bool headless = getenv(HEADLESS_VARIABLE) != NULL;
+  if (headless) {
+    setenv("SDL_VIDEODRIVER", "dummy", false);
+  }
   SDL_Init(SDL_INIT_EVERYTHING);
 
   // Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048);
 
-  window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED,
-                            SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT,
-                            SDL_WINDOW_RESIZABLE);
-  renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+  window = SDL_CreateWindow(
+      WINDOW_TITLE, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+      WINDOW_WIDTH, WINDOW_HEIGHT,
+      headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_RESIZABLE);
+  renderer = SDL_CreateRenderer(
+      window, -1, headless ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_PRESENTVSYNC);
+  update_transform();
+  start_capture();
   // SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN_DESKTOP);
 }
 
@@ -151,111 +491,644 @@ void sdl_init(vector_t min, vector_t max) {
 //   return Mix_LoadWAV(wav_file_name);
 // }
 
+/**
+ * Converts an SDL key event to the values passed to a key handler.
+ *
+ * @return false if the key is not recognized
+ */
+bool read_key_event(SDL_KeyboardEvent *event, key_event_t *key_event) {
+  key_event->key = get_keycode(event->keysym.sym);
+  if (key_event->key == '\0') {
+    return false;
+  }
+  uint32_t timestamp = event->timestamp;
+  if (!event->repeat) {
+    key_start_timestamp = timestamp;
+  }
+  key_event->type = event->type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
+  key_event->held_time = (timestamp - key_start_timestamp) / MS_PER_S;
+  return true;
+}
+
+/**
+ * Applies a key event to the key state, adds it to this frame's events,
+ * and passes it to the key handler if there is one.
+ */
+void record_key_event(key_event_t event, void *state) {
+  uint8_t key = event.key;
+  uint64_t bit = (uint64_t)1 << (key % 64);
+  if (event.type == KEY_PRESSED) {
+    keys_down[key / 64] |= bit;
+  } else {
+    keys_down[key / 64] &= ~bit;
+  }
+  if (key_event_count < KEY_EVENT_CAPACITY) {
+    key_events[key_event_count++] = event;
+  }
+  if (replay != NULL && !replaying) {
+    replay_write_key(replay, event);
+  }
+  if (key_handler != NULL) {
+    key_handler(event.key, event.type, event.held_time, state);
+  }
+}
+
+/**
+ * Feeds the key events logged before the next tick back in.
+ *
+ * @return true if the log has run out
+ */
+bool play_key_events(void *state) {
+  while (replay_next(replay) == REPLAY_KEY) {
+    record_key_event(replay_read_key(replay), state);
+  }
+  return replay_next(replay) == REPLAY_END;
+}
+
+/** Checks whether the requested number of frames has been captured */
+bool capture_finished(void) {
+  return capture != NULL && capture_limit > 0 && frames_shown >= capture_limit;
+}
+
+#ifdef RENDER_THREAD
 bool sdl_is_done(void *state) {
-  SDL_Event *event = malloc(sizeof(*event));
-  assert(event != NULL);
-  while (SDL_PollEvent(event)) {
-    switch (event->type) {
+  // copy the events out so the handler runs without holding the lock
+  key_event_t keys[KEY_EVENT_CAPACITY];
+  pthread_mutex_lock(&event_lock);
+  size_t key_count = key_queue_count;
+  memcpy(keys, key_queue, key_count * sizeof(*keys));
+  key_queue_count = 0;
+  bool done = quit_requested;
+  pthread_mutex_unlock(&event_lock);
+
+  key_event_count = 0;
+  if (replaying) {
+    // the keyboard is ignored while a log is played back
+    done = play_key_events(state) || done;
+  } else {
+    for (size_t i = 0; i < key_count; i++) {
+      record_key_event(keys[i], state);
+    }
+  }
+  if (done) {
+    // nothing will be published after this, so the render thread stops too
+    pthread_mutex_lock(&event_lock);
+    simulation_finished = true;
+    pthread_mutex_unlock(&event_lock);
+  }
+  return done;
+}
+
+/**
+ * Processes all SDL events on the render thread.
+ * Key events are queued for sdl_is_done() on the simulation thread.
+ *
+ * @return true if the window was closed, false otherwise
+ */
+bool poll_events(void) {
+  SDL_Event event;
+  bool done = capture_finished();
+  while (SDL_PollEvent(&event)) {
+    switch (event.type) {
     case SDL_QUIT:
-      free(event);
-      return true;
+      done = true;
+      break;
     case SDL_KEYDOWN:
-    case SDL_KEYUP:
-      // Skip the keypress if no handler is configured
-      // or an unrecognized key was pressed
-      if (key_handler == NULL)
-        break;
-      char key = get_keycode(event->key.keysym.sym);
-      if (key == '\0')
+    case SDL_KEYUP:;
+      key_event_t queued;
+      if (!read_key_event(&event.key, &queued)) {
         break;
-
-      uint32_t timestamp = event->key.timestamp;
-      if (!event->key.repeat) {
-        key_start_timestamp = timestamp;
       }
-      key_event_type_t type =
-          event->type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
-      double held_time = (timestamp - key_start_timestamp) / MS_PER_S;
-      key_handler(key, type, held_time, state);
+      pthread_mutex_lock(&event_lock);
+      // a simulation that has fallen this far behind loses the newest keys
+      if (key_queue_count < KEY_EVENT_CAPACITY) {
+        key_queue[key_queue_count++] = queued;
+      }
+      pthread_mutex_unlock(&event_lock);
       break;
     }
   }
-  free(event);
-  return false;
+  if (done) {
+    pthread_mutex_lock(&event_lock);
+    quit_requested = true;
+    pthread_mutex_unlock(&event_lock);
+  }
+  return done;
 }
+#else
+bool sdl_is_done(void *state) {
+  SDL_Event event;
+  key_event_count = 0;
+  while (SDL_PollEvent(&event)) {
+    switch (event.type) {
+    case SDL_QUIT:
+      return true;
+    case SDL_WINDOWEVENT:
+      if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+        update_transform();
+      }
+      break;
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:;
+      // Skip the keypress if an unrecognized key was pressed,
+      // or if the keys are coming from a log instead
+      key_event_t key_event;
+      if (!replaying && read_key_event(&event.key, &key_event)) {
+        record_key_event(key_event, state);
+      }
+      break;
+    }
+  }
+  if (replaying && play_key_events(state)) {
+    return true;
+  }
+  return capture_finished();
+}
+#endif
 
 void sdl_clear(void) {
-  SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-  SDL_RenderClear(renderer);
+  // a new frame; also catches resizes made since the last event poll
+  update_transform();
+  backend->clear();
 }
 
 void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   // Check parameters
-  size_t n = list_size(points);
-  assert(n >= 3);
+  assert(list_size(points) >= 3);
   assert(0 <= color.r && color.r <= 1);
   assert(0 <= color.g && color.g <= 1);
   assert(0 <= color.b && color.b <= 1);
+  backend->draw_polygon(points, color);
+}
 
-  vector_t window_center = get_window_center();
+void sdl_show(void) {
+  // Draw boundary lines
+  vector_t view_center = vec_add(center, camera);
+  vector_t max = vec_add(view_center, max_diff),
+           min = vec_subtract(view_center, max_diff);
+  vector_t max_pixel = get_window_position(max),
+           min_pixel = get_window_position(min);
+  backend->draw_outline(min_pixel.x, max_pixel.y, max_pixel.x - min_pixel.x,
+                        min_pixel.y - max_pixel.y);
 
-  // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
-  for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
-    x_points[i] = pixel.x;
-    y_points[i] = pixel.y;
+  if (capture != NULL) {
+    capture_shown_frame();
   }
+  frames_shown++;
+  backend->present();
+}
+
+void sdl_backend_get_size(int *width, int *height) {
+  SDL_GetWindowSize(window, width, height);
+}
+
+void sdl_backend_clear(void) {
+  SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+  SDL_RenderClear(renderer);
+}
+
+void sdl_backend_draw_polygon(list_t *points, rgb_color_t color) {
+  // Convert each vertex to a point on screen
+  size_t n = list_size(points);
+  arena_t *arena = frame_arena();
+  arena_mark_t mark = arena_mark(arena);
+  int16_t *x_points = arena_alloc(arena, sizeof(*x_points) * n),
+          *y_points = arena_alloc(arena, sizeof(*y_points) * n);
+  get_window_positions(points, x_points, y_points);
 
   // Draw polygon with the given color
   filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
                     color.g * 255, color.b * 255, 255);
-  free(x_points);
-  free(y_points);
+  arena_rewind(arena, mark);
 }
 
-void sdl_show(void) {
-  // Draw boundary lines
-  vector_t window_center = get_window_center();
-  vector_t max = vec_add(center, max_diff),
-           min = vec_subtract(center, max_diff);
-  vector_t max_pixel = get_window_position(max, window_center),
-           min_pixel = get_window_position(min, window_center);
-  SDL_Rect *boundary = malloc(sizeof(*boundary));
-  boundary->x = min_pixel.x;
-  boundary->y = max_pixel.y;
-  boundary->w = max_pixel.x - min_pixel.x;
-  boundary->h = min_pixel.y - max_pixel.y;
+void sdl_backend_draw_outline(int x, int y, int width, int height) {
+  SDL_Rect boundary = {.x = x, .y = y, .w = width, .h = height};
   SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-  SDL_RenderDrawRect(renderer, boundary);
-  free(boundary);
+  SDL_RenderDrawRect(renderer, &boundary);
+}
+
+void sdl_backend_read_rgb(uint8_t *rgb, int width, int height) {
+  SDL_Rect frame = {.x = 0, .y = 0, .w = width, .h = height};
+  SDL_RenderReadPixels(renderer, &frame, SDL_PIXELFORMAT_RGB24, rgb,
+                       3 * width);
+}
+
+void sdl_backend_present(void) { SDL_RenderPresent(renderer); }
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+void batch_reserve(size_t vertices, size_t indices) {
+  if (vertices > batch_vertex_capacity) {
+    batch_vertex_capacity = 2 * vertices;
+    batch_vertices = realloc(batch_vertices,
+                             batch_vertex_capacity * sizeof(*batch_vertices));
+    assert(batch_vertices != NULL);
+  }
+  if (indices > batch_index_capacity) {
+    batch_index_capacity = 2 * indices;
+    batch_indices =
+        realloc(batch_indices, batch_index_capacity * sizeof(*batch_indices));
+    assert(batch_indices != NULL);
+  }
+}
+
+/** Maps a scene point into the batch's vertex at the given index */
+void batch_set_vertex(size_t index, vector_t point, SDL_Color color) {
+  batch_vertices[index] = (SDL_Vertex){{pixel_offset.x + pixel_scale * point.x,
+                                        pixel_offset.y - pixel_scale * point.y},
+                                       color,
+                                       {0, 0}};
+}
+
+/**
+ * Reserves a fan of n triangles around a hub vertex at the end of the batch
+ * and fills in the hub and the indices. The caller sets the n rim vertices
+ * with batch_set_vertex(), starting at the returned vertex index.
+ * Advances vertex_count and index_count past the added triangles.
+ */
+size_t batch_add_fan(size_t n, vector_t hub, SDL_Color color,
+                     size_t *vertex_count, size_t *index_count) {
+  assert(n >= 3);
+  batch_reserve(*vertex_count + n + 1, *index_count + 3 * n);
+  size_t hub_index = *vertex_count;
+  batch_set_vertex(hub_index, hub, color);
+  for (size_t i = 0; i < n; i++) {
+    int *triangle = batch_indices + *index_count + 3 * i;
+    triangle[0] = hub_index;
+    triangle[1] = hub_index + 1 + i;
+    triangle[2] = hub_index + 1 + (i + 1) % n;
+  }
+  *vertex_count += n + 1;
+  *index_count += 3 * n;
+  return hub_index + 1;
+}
+
+SDL_Color get_pixel_color(rgb_color_t color) {
+  return (SDL_Color){color.r * 255, color.g * 255, color.b * 255, 255};
+}
+
+/**
+ * Appends a polygon to the batch as a fan of triangles around its centroid.
+ * Exact for the star-shaped polygons bodies are made of.
+ */
+void batch_add_polygon(list_t *points, vector_t centroid, rgb_color_t color,
+                       size_t *vertex_count, size_t *index_count) {
+  size_t n = list_size(points);
+  SDL_Color pixel_color = get_pixel_color(color);
+  size_t first =
+      batch_add_fan(n, centroid, pixel_color, vertex_count, index_count);
+  for (size_t i = 0; i < n; i++) {
+    batch_set_vertex(first + i, *(vector_t *)list_get(points, i), pixel_color);
+  }
+}
+
+/** Submits everything added to the batch in one draw call */
+void batch_draw(size_t vertex_count, size_t index_count) {
+  if (index_count > 0) {
+    SDL_RenderGeometry(renderer, NULL, batch_vertices, vertex_count,
+                       batch_indices, index_count);
+  }
+}
+#endif
+
+/** Draws the visible immovable bodies of a scene to the current target */
+void draw_immovable_bodies(scene_t *scene) {
+  size_t body_count = scene_bodies(scene);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  size_t vertex_count = 0, index_count = 0;
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (body_is_immovable(body) && body_is_visible(body)) {
+      batch_add_polygon(body_get_real_shape(body), body_get_centroid(body),
+                        body_get_color(body), &vertex_count, &index_count);
+    }
+  }
+  batch_draw(vertex_count, index_count);
+#else
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (body_is_immovable(body) && body_is_visible(body)) {
+      sdl_draw_polygon(body_get_real_shape(body), body_get_color(body));
+    }
+  }
+#endif
+}
+
+/**
+ * Brings the static layer up to date with the scene and the window,
+ * redrawing it only if an immovable body or the transform has changed.
+ *
+ * @return false if the renderer cannot draw to textures
+ */
+bool update_static_layer(scene_t *scene) {
+  if (!SDL_RenderTargetSupported(renderer)) {
+    return false;
+  }
+  int width, height;
+  SDL_GetWindowSize(window, &width, &height);
+  // a counter check, so the cost does not grow with the immovable bodies
+  size_t version = body_static_version();
+  if (static_layer != NULL && width == static_layer_width &&
+      height == static_layer_height && scene == static_layer_scene &&
+      version == static_layer_version && pixel_scale == static_layer_scale &&
+      pixel_offset.x == static_layer_offset.x &&
+      pixel_offset.y == static_layer_offset.y) {
+    return true;
+  }
+  if (static_layer == NULL || width != static_layer_width ||
+      height != static_layer_height) {
+    SDL_DestroyTexture(static_layer);
+    static_layer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                     SDL_TEXTUREACCESS_TARGET, width, height);
+    if (static_layer == NULL) {
+      return false;
+    }
+    SDL_SetTextureBlendMode(static_layer, SDL_BLENDMODE_BLEND);
+    static_layer_width = width;
+    static_layer_height = height;
+  }
+  SDL_SetRenderTarget(renderer, static_layer);
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+  SDL_RenderClear(renderer);
+  draw_immovable_bodies(scene);
+  SDL_SetRenderTarget(renderer, NULL);
+  static_layer_scene = scene;
+  static_layer_version = version;
+  static_layer_scale = pixel_scale;
+  static_layer_offset = pixel_offset;
+  return true;
+}
+
+#ifdef RENDER_THREAD
+/** Copies every body's shape, color and bounds into a snapshot */
+void snapshot_take(snapshot_t *snapshot, scene_t *scene) {
+  size_t body_count = scene_bodies(scene);
+  if (body_count > snapshot->body_capacity) {
+    snapshot->body_capacity = 2 * body_count;
+    snapshot->bodies = realloc(
+        snapshot->bodies, snapshot->body_capacity * sizeof(*snapshot->bodies));
+    assert(snapshot->bodies != NULL);
+  }
+  snapshot->body_count = body_count;
+  snapshot->point_count = 0;
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    list_t *shape = body_get_real_shape(body);
+    size_t n = list_size(shape);
+    if (snapshot->point_count + n > snapshot->point_capacity) {
+      snapshot->point_capacity = 2 * (snapshot->point_count + n);
+      snapshot->points =
+          realloc(snapshot->points,
+                  snapshot->point_capacity * sizeof(*snapshot->points));
+      assert(snapshot->points != NULL);
+    }
+    for (size_t j = 0; j < n; j++) {
+      vector_t *vertex = list_get(shape, j);
+      snapshot->points[snapshot->point_count + j] = *vertex;
+    }
+    snapshot_body_t *copy = &snapshot->bodies[i];
+    copy->centroid = body_get_centroid(body);
+    copy->radius = body_get_radius(body);
+    copy->color = body_get_color(body);
+    copy->first_point = snapshot->point_count;
+    copy->point_count = n;
+    snapshot->point_count += n;
+  }
+  snapshot->camera = next_camera;
+}
 
-  SDL_RenderPresent(renderer);
+/** Draws the visible bodies of a snapshot in one draw call */
+void snapshot_draw(snapshot_t *snapshot) {
+  size_t vertex_count = 0, index_count = 0;
+  for (size_t i = 0; i < snapshot->body_count; i++) {
+    snapshot_body_t *body = &snapshot->bodies[i];
+    if (!is_visible(body->centroid, body->radius)) {
+      continue;
+    }
+    SDL_Color color = get_pixel_color(body->color);
+    size_t first = batch_add_fan(body->point_count, body->centroid, color,
+                                 &vertex_count, &index_count);
+    vector_t *points = snapshot->points + body->first_point;
+    for (size_t j = 0; j < body->point_count; j++) {
+      batch_set_vertex(first + j, points[j], color);
+    }
+  }
+  batch_draw(vertex_count, index_count);
 }
 
 void sdl_render_scene(scene_t *scene) {
+  PROFILE_BEGIN(PROFILE_RENDER);
+  // only copies the scene; the render thread draws it in sdl_render_frame()
+  snapshot_take(&snapshots[write_index], scene);
+  pthread_mutex_lock(&snapshot_lock);
+  size_t published = write_index;
+  write_index = ready_index;
+  ready_index = published;
+  snapshot_fresh = true;
+  pthread_mutex_unlock(&snapshot_lock);
+  PROFILE_END(PROFILE_RENDER);
+}
+
+bool sdl_render_frame(void) {
+  if (poll_events()) {
+    return false;
+  }
+  pthread_mutex_lock(&event_lock);
+  bool finished = simulation_finished;
+  pthread_mutex_unlock(&event_lock);
+  if (finished) {
+    return false;
+  }
+  pthread_mutex_lock(&snapshot_lock);
+  if (snapshot_fresh) {
+    size_t latest = ready_index;
+    ready_index = read_index;
+    read_index = latest;
+    snapshot_fresh = false;
+  }
+  pthread_mutex_unlock(&snapshot_lock);
+
+  snapshot_t *snapshot = &snapshots[read_index];
+  camera = snapshot->camera;
+  sdl_clear();
+  snapshot_draw(snapshot);
+  // blocks for vsync on this thread only
+  sdl_show();
+  return true;
+}
+#else
+void sdl_backend_render_scene(scene_t *scene) {
+  // the layer is drawn off-screen, so bring it up to date before clearing
+  update_transform();
+  bool static_cached = update_static_layer(scene);
   sdl_clear();
+  if (static_cached) {
+    SDL_RenderCopy(renderer, static_layer, NULL, NULL);
+  }
   size_t body_count = scene_bodies(scene);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  // one draw call for the whole scene instead of one software fill per body
+  size_t vertex_count = 0, index_count = 0;
   for (size_t i = 0; i < body_count; i++) {
     body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-    sdl_draw_polygon(shape, body_get_color(body));
-    list_free(shape);
+    if ((static_cached && body_is_immovable(body)) ||
+        !body_is_visible(body)) {
+      continue;
+    }
+    batch_add_polygon(body_get_real_shape(body), body_get_centroid(body),
+                      body_get_color(body), &vertex_count, &index_count);
   }
+  batch_draw(vertex_count, index_count);
+#else
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    if ((static_cached && body_is_immovable(body)) ||
+        !body_is_visible(body)) {
+      continue;
+    }
+    // sdl_draw_polygon() only reads the shape, so it need not be copied
+    sdl_draw_polygon(body_get_real_shape(body), body_get_color(body));
+  }
+#endif
   sdl_show();
 }
 
+void sdl_render_scene(scene_t *scene) {
+  PROFILE_BEGIN(PROFILE_RENDER);
+  backend->render_scene(scene);
+  PROFILE_END(PROFILE_RENDER);
+}
+#endif
+
+void software_get_size(int *width, int *height) {
+  *width = raster_width(raster);
+  *height = raster_height(raster);
+}
+
+void software_clear(void) { raster_clear(raster, SOFTWARE_BACKGROUND); }
+
+void software_draw_polygon(list_t *points, rgb_color_t color) {
+  // keep the vertices unrounded so edges are placed to a fraction of a pixel
+  size_t n = list_size(points);
+  arena_t *arena = frame_arena();
+  arena_mark_t mark = arena_mark(arena);
+  vector_t *pixels = arena_alloc(arena, sizeof(*pixels) * n);
+  for (size_t i = 0; i < n; i++) {
+    vector_t *vertex = list_get(points, i);
+    pixels[i] = (vector_t){pixel_offset.x + pixel_scale * vertex->x,
+                           pixel_offset.y - pixel_scale * vertex->y};
+  }
+  uint32_t argb = 0xff000000 | (uint32_t)(color.r * 255) << 16 |
+                  (uint32_t)(color.g * 255) << 8 | (uint32_t)(color.b * 255);
+  raster_fill_polygon(raster, pixels, n, argb);
+  arena_rewind(arena, mark);
+}
+
+void software_draw_outline(int x, int y, int width, int height) {
+  raster_outline_rect(raster, x, y, width, height, SOFTWARE_BOUNDARY);
+}
+
+void software_read_rgb(uint8_t *rgb, int width, int height) {
+  raster_read_rgb(raster, rgb);
+}
+
+void software_present(void) {
+  // the frame stays in the framebuffer, where it can be captured
+}
+
+void software_render_scene(scene_t *scene) {
+  sdl_clear();
+  size_t body_count = scene_bodies(scene);
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (body_is_visible(body)) {
+      sdl_draw_polygon(body_get_real_shape(body), body_get_color(body));
+    }
+  }
+  sdl_show();
+}
+
+const renderer_backend_t sdl_backend = {
+    .get_size = sdl_backend_get_size,
+    .clear = sdl_backend_clear,
+    .draw_polygon = sdl_backend_draw_polygon,
+    .draw_outline = sdl_backend_draw_outline,
+    .read_rgb = sdl_backend_read_rgb,
+    .present = sdl_backend_present,
+#ifndef RENDER_THREAD
+    .render_scene = sdl_backend_render_scene,
+#endif
+};
+
+const renderer_backend_t software_backend = {
+    .get_size = software_get_size,
+    .clear = software_clear,
+    .draw_polygon = software_draw_polygon,
+    .draw_outline = software_draw_outline,
+    .read_rgb = software_read_rgb,
+    .present = software_present,
+    .render_scene = software_render_scene,
+};
+
+#ifdef RENDER_THREAD
+void sdl_set_camera(vector_t offset) { next_camera = offset; }
+
+vector_t sdl_get_camera(void) { return next_camera; }
+#else
+void sdl_set_camera(vector_t offset) {
+  camera = offset;
+  if (window != NULL) {
+    update_transform();
+  }
+}
+
+vector_t sdl_get_camera(void) { return camera; }
+#endif
+
 void sdl_on_key(key_handler_t handler) { key_handler = handler; }
 
-double time_since_last_tick(void) {
+bool sdl_key_down(char key) {
+  uint8_t index = key;
+  assert(index < KEY_COUNT);
+  return keys_down[index / 64] >> (index % 64) & 1;
+}
+
+const key_event_t *sdl_key_events(size_t *count) {
+  *count = key_event_count;
+  return key_events;
+}
+
+/** Measures the time since the last tick */
+double measure_tick_time(void) {
+  // recordings advance by exactly one frame per tick, however long it took
+  if (capture != NULL) {
+    return 1 / CAPTURE_FPS;
+  }
+#ifdef RENDER_THREAD
+  uint64_t now = SDL_GetPerformanceCounter();
+  double difference =
+      last_counter
+          ? (double)(now - last_counter) / SDL_GetPerformanceFrequency()
+          : 0.0; // return 0 the first time this is called
+  last_counter = now;
+#else
   clock_t now = clock();
   double difference = last_clock
                           ? (double)(now - last_clock) / CLOCKS_PER_SEC
                           : 0.0; // return 0 the first time this is called
   last_clock = now;
+#endif
   return difference;
 }
+
+double time_since_last_tick(void) {
+  if (replaying) {
+    // played back as fast as possible, but with the recorded times
+    return replay_next(replay) == REPLAY_TICK ? replay_read_tick(replay) : 0.0;
+  }
+  double dt = measure_tick_time();
+  if (replay != NULL) {
+    replay_write_tick(replay, dt);
+  }
+  return dt;
+}
@@ -1,8 +1,23 @@
 #include "vector.h"
+#include "pool.h"
 #include <math.h>
 #include <stdlib.h>
 
 const vector_t VEC_ZERO = {0, 0};
+const size_t VECTOR_POOL_CHUNK = 1024;
+
+pool_t *vector_pool = NULL;
+
+vector_t *vec_alloc(vector_t v) {
+  if (vector_pool == NULL) {
+    vector_pool = pool_init(sizeof(vector_t), VECTOR_POOL_CHUNK);
+  }
+  vector_t *vector = pool_alloc(vector_pool);
+  *vector = v;
+  return vector;
+}
+
+void vec_free(void *v) { pool_release(vector_pool, v); }
 
 int vec_equal(vector_t v1, vector_t v2) { return v1.x == v2.x && v1.y == v2.y; }
 
@@ -0,0 +1,111 @@
+#include "alloc.h"
+#include "forces.h"
+#include "polygon.h"
+#include "scene.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdint.h>
+
+const size_t STARS = 12;
+const size_t WARM_UP_TICKS = 300, STEADY_TICKS = 300;
+const double DT = 1e-3;
+const rgb_color_t STAR_COLOR = {0.5, 0.5, 0.5};
+
+void test_alloc_counts() {
+  alloc_reset_stats();
+  alloc_stats_t before = alloc_get_stats(ALLOC_OTHER);
+  char *memory = engine_malloc(100, ALLOC_OTHER);
+  assert((uintptr_t)memory % _Alignof(max_align_t) == 0);
+  memory[99] = 'x';
+  alloc_stats_t stats = alloc_get_stats(ALLOC_OTHER);
+  assert(stats.allocations == 1 && stats.frees == 0);
+  assert(stats.bytes == 100);
+  assert(stats.live_bytes == before.live_bytes + 100);
+  // a resize counts as a new allocation of the new size
+  memory = engine_realloc(memory, 300, ALLOC_OTHER);
+  assert(memory[99] == 'x');
+  stats = alloc_get_stats(ALLOC_OTHER);
+  assert(stats.allocations == 2 && stats.frees == 1);
+  assert(stats.bytes == 400);
+  assert(stats.live_bytes == before.live_bytes + 300);
+  engine_free(memory);
+  engine_free(NULL);
+  stats = alloc_get_stats(ALLOC_OTHER);
+  assert(stats.frees == 2);
+  assert(stats.live_bytes == before.live_bytes);
+  assert(stats.peak_bytes == before.live_bytes + 300);
+  assert(alloc_total_stats().allocations == 2);
+  // resetting keeps what is live, and lowers the peak to it
+  alloc_reset_stats();
+  stats = alloc_get_stats(ALLOC_OTHER);
+  assert(stats.allocations == 0 && stats.frees == 0 && stats.bytes == 0);
+  assert(stats.peak_bytes == stats.live_bytes);
+}
+
+body_t *add_star(scene_t *scene, size_t i) {
+  vector_t center = {20.0 * (i % 4), 20.0 * (i / 4 % 3)};
+  body_t *star = body_init(make_star(5, 4, 7, center, 0), 1, STAR_COLOR);
+  body_set_velocity(star, (vector_t){(double)(i % 3) - 1, (double)(i % 5) - 2});
+  scene_add_body(scene, star);
+  list_t *bodies = list_init(1, NULL);
+  list_add(bodies, star);
+  create_drag(scene, 0.1, bodies);
+  for (size_t j = 0; j + 1 < scene_bodies(scene); j++) {
+    body_t *other = scene_get_body(scene, j);
+    bodies = list_init(2, NULL);
+    list_add(bodies, star);
+    list_add(bodies, other);
+    create_newtonian_gravity(scene, 100, bodies);
+    bodies = list_init(2, NULL);
+    list_add(bodies, star);
+    list_add(bodies, other);
+    create_physics_collision(scene, 0.9, bodies);
+  }
+  return star;
+}
+
+/** Ticks a scene, replacing its oldest star every few ticks */
+void churn(scene_t *scene, size_t ticks, size_t *added) {
+  for (size_t i = 0; i < ticks; i++) {
+    if (i % 10 == 0) {
+      scene_remove_body(scene, 0);
+      scene_tick(scene, DT);
+      add_star(scene, (*added)++);
+    }
+    scene_tick(scene, DT);
+  }
+}
+
+void test_alloc_steady_state() {
+  scene_t *scene = scene_init();
+  size_t added = 0;
+  while (added < STARS) {
+    add_star(scene, added++);
+  }
+  // the pools and scene arrays grow to fit while warming up...
+  churn(scene, WARM_UP_TICKS, &added);
+  alloc_reset_stats();
+  // ...and are reused from then on, even as bodies come and go
+  churn(scene, STEADY_TICKS, &added);
+  alloc_stats_t stats = alloc_total_stats();
+  if (stats.allocations != 0) {
+    alloc_report(stderr);
+  }
+  assert(stats.allocations == 0);
+  scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_alloc_counts)
+  DO_TEST(test_alloc_steady_state)
+
+  puts("alloc_test PASS");
+}
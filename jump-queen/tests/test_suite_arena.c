@@ -0,0 +1,86 @@
+#include "arena.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+void test_arena_alignment() {
+  arena_t *arena = arena_init(256);
+  for (size_t size = 1; size < 40; size += 3) {
+    void *memory = arena_alloc(arena, size);
+    assert((uintptr_t)memory % _Alignof(max_align_t) == 0);
+    memset(memory, 0xff, size);
+  }
+  arena_free(arena);
+}
+
+void test_arena_reset() {
+  arena_t *arena = arena_init(256);
+  char *first = arena_alloc(arena, 10);
+  arena_alloc(arena, 100);
+  assert(arena_used(arena) >= 110);
+  arena_reset(arena);
+  assert(arena_used(arena) == 0);
+  assert(arena_alloc(arena, 10) == first);
+  arena_free(arena);
+}
+
+void test_arena_growth() {
+  const size_t ALLOCATIONS = 100, SIZE = 48;
+  arena_t *arena = arena_init(64);
+  char *blocks[ALLOCATIONS];
+  for (size_t i = 0; i < ALLOCATIONS; i++) {
+    blocks[i] = arena_alloc(arena, SIZE);
+    memset(blocks[i], i, SIZE);
+  }
+  // growing never moves earlier allocations
+  for (size_t i = 0; i < ALLOCATIONS; i++) {
+    for (size_t j = 0; j < SIZE; j++) {
+      assert(blocks[i][j] == (char)i);
+    }
+  }
+  // after a reset the same frame fits in one contiguous block
+  arena_reset(arena);
+  char *start = arena_alloc(arena, SIZE);
+  char *previous = start;
+  for (size_t i = 1; i < ALLOCATIONS; i++) {
+    char *next = arena_alloc(arena, SIZE);
+    assert(next > previous);
+    previous = next;
+  }
+  assert((size_t)(previous - start) < ALLOCATIONS * 2 * SIZE);
+  arena_free(arena);
+}
+
+void test_arena_rewind() {
+  arena_t *arena = arena_init(256);
+  arena_alloc(arena, 16);
+  arena_mark_t mark = arena_mark(arena);
+  void *scratch = arena_alloc(arena, 64);
+  arena_rewind(arena, mark);
+  assert(arena_mark(arena) == mark);
+  assert(arena_alloc(arena, 64) == scratch);
+  // rewinding across a grown block keeps the arena usable
+  mark = arena_mark(arena);
+  arena_alloc(arena, 1024);
+  arena_rewind(arena, mark);
+  memset(arena_alloc(arena, 512), 0, 512);
+  arena_free(arena);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_arena_alignment)
+  DO_TEST(test_arena_reset)
+  DO_TEST(test_arena_growth)
+  DO_TEST(test_arena_rewind)
+
+  puts("arena_test PASS");
+}
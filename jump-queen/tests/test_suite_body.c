@@ -1,4 +1,5 @@
 #include "body.h"
+#include "polygon.h"
 #include "test_util.h"
 #include <assert.h>
 #include <math.h>
@@ -248,6 +249,59 @@ void test_body_info_freer() {
   body_free(body);
 }
 
+void test_body_radius() {
+  vector_t v[] = {{1, 1}, {3, 1}, {3, 2}, {1, 2}};
+  const size_t VERTICES = sizeof(v) / sizeof(*v);
+  list_t *shape = list_init(VERTICES, free);
+  for (size_t i = 0; i < VERTICES; i++) {
+    vector_t *list_v = malloc(sizeof(*list_v));
+    *list_v = v[i];
+    list_add(shape, list_v);
+  }
+  body_t *body = body_init(shape, 1, (rgb_color_t){0, 0, 0});
+  assert(isclose(body_get_radius(body), sqrt(1.25)));
+  body_set_centroid(body, (vector_t){10, 10});
+  body_set_rotation(body, M_PI / 3);
+  assert(isclose(body_get_radius(body), sqrt(1.25)));
+  body_dilate(body, 2);
+  assert(isclose(body_get_radius(body), 2 * sqrt(1.25)));
+  body_dilate_y(body, 0);
+  assert(body_get_radius(body) < 2 * sqrt(1.25));
+  body_free(body);
+}
+
+void test_static_version() {
+  body_t *wall = body_init(make_rectangle(VEC_ZERO, (vector_t){1, 1}),
+                           INFINITY, (rgb_color_t){0, 0, 0});
+  body_t *ball = body_init(make_rectangle(VEC_ZERO, (vector_t){1, 1}), 1,
+                           (rgb_color_t){0, 0, 0});
+  size_t version = body_static_version();
+  // changes to movable bodies and no-op changes leave the cache alone
+  body_set_centroid(ball, (vector_t){5, 5});
+  body_set_color(ball, (rgb_color_t){1, 0, 0});
+  body_set_centroid(wall, body_get_centroid(wall));
+  body_set_rotation(wall, body_get_rotation(wall));
+  body_set_color(wall, body_get_color(wall));
+  assert(body_static_version() == version);
+  body_set_centroid(wall, (vector_t){2, 2});
+  assert(body_static_version() != version);
+  version = body_static_version();
+  body_set_color(wall, (rgb_color_t){0, 1, 0});
+  assert(body_static_version() != version);
+  version = body_static_version();
+  // moving makes the wall leave the cache, and stopping brings it back
+  body_set_velocity(wall, (vector_t){1, 0});
+  assert(body_static_version() != version);
+  version = body_static_version();
+  body_set_velocity(wall, VEC_ZERO);
+  assert(body_static_version() != version);
+  version = body_static_version();
+  body_free(ball);
+  assert(body_static_version() == version);
+  body_free(wall);
+  assert(body_static_version() != version);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -265,6 +319,8 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_body_remove)
   DO_TEST(test_body_info)
   DO_TEST(test_body_info_freer)
+  DO_TEST(test_body_radius)
+  DO_TEST(test_static_version)
 
   puts("body_test PASS");
 }
@@ -0,0 +1,120 @@
+#include "capture.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t WIDTH = 4, HEIGHT = 3;
+
+/** Fills a frame with a pattern that depends on the frame number */
+void fill_frame(uint8_t *pixels, size_t frame) {
+  for (size_t i = 0; i < WIDTH * HEIGHT * 3; i++) {
+    pixels[i] = frame * 16 + i;
+  }
+}
+
+/** Reads one PPM frame from a file and checks it matches fill_frame() */
+void check_frame(FILE *file, size_t frame) {
+  size_t width, height;
+  int max;
+  assert(fscanf(file, "P6 %zu %zu %d", &width, &height, &max) == 3);
+  assert(width == WIDTH && height == HEIGHT && max == 255);
+  assert(fgetc(file) == '\n');
+  uint8_t expected[WIDTH * HEIGHT * 3], actual[WIDTH * HEIGHT * 3];
+  fill_frame(expected, frame);
+  assert(fread(actual, 1, sizeof(actual), file) == sizeof(actual));
+  assert(memcmp(actual, expected, sizeof(actual)) == 0);
+}
+
+/** Captures the given number of frames, never dropping any */
+void capture_frames_to(const char *destination, size_t frames) {
+  capture_t *capture = capture_init(destination, WIDTH, HEIGHT, frames);
+  for (size_t i = 0; i < frames; i++) {
+    uint8_t *pixels = capture_next_frame(capture);
+    assert(pixels != NULL);
+    fill_frame(pixels, i);
+    capture_submit(capture);
+  }
+  assert(capture_frames(capture) == frames);
+  assert(capture_dropped(capture) == 0);
+  capture_free(capture);
+}
+
+void test_capture_stream() {
+  const char *path = "/tmp/test_capture_stream.ppm";
+  capture_frames_to(path, 3);
+  FILE *file = fopen(path, "rb");
+  assert(file != NULL);
+  for (size_t i = 0; i < 3; i++) {
+    check_frame(file, i);
+  }
+  assert(fgetc(file) == EOF);
+  fclose(file);
+  remove(path);
+}
+
+void test_capture_sequence() {
+  capture_frames_to("/tmp/test_capture_###.ppm", 3);
+  char path[100];
+  for (size_t i = 0; i < 3; i++) {
+    sprintf(path, "/tmp/test_capture_%03zu.ppm", i);
+    FILE *file = fopen(path, "rb");
+    assert(file != NULL);
+    check_frame(file, i);
+    fclose(file);
+    remove(path);
+  }
+}
+
+void test_capture_pipe() {
+  const char *path = "/tmp/test_capture_pipe.ppm";
+  capture_frames_to("|cat > /tmp/test_capture_pipe.ppm", 2);
+  FILE *file = fopen(path, "rb");
+  assert(file != NULL);
+  check_frame(file, 0);
+  check_frame(file, 1);
+  fclose(file);
+  remove(path);
+}
+
+void test_capture_drops_when_full() {
+  const char *path = "/tmp/test_capture_drops.ppm";
+  capture_t *capture = capture_init(path, WIDTH, HEIGHT, 1);
+  size_t kept = 0;
+  for (size_t i = 0; i < 100; i++) {
+    uint8_t *pixels = capture_next_frame(capture);
+    if (pixels != NULL) {
+      fill_frame(pixels, kept++);
+      capture_submit(capture);
+    }
+  }
+  assert(capture_frames(capture) == kept);
+  assert(capture_dropped(capture) == 100 - kept);
+  capture_free(capture);
+  // every frame that was kept was written, in order
+  FILE *file = fopen(path, "rb");
+  assert(file != NULL);
+  for (size_t i = 0; i < kept; i++) {
+    check_frame(file, i);
+  }
+  fclose(file);
+  remove(path);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_capture_stream)
+  DO_TEST(test_capture_sequence)
+  DO_TEST(test_capture_pipe)
+  DO_TEST(test_capture_drops_when_full)
+
+  puts("capture_test PASS");
+}
@@ -0,0 +1,99 @@
+#include "level.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+const char *LEVEL_PATH = "/tmp/test_level.lvl";
+
+level_platform_t make_test_platform(uint32_t type, uint32_t screen,
+                                    double x) {
+  return (level_platform_t){.type = type,
+                            .screen = screen,
+                            .bottom_left = {x, screen + 0.25},
+                            .top_right = {x + 0.1, screen + 0.5},
+                            .velocity = {0.1, 0},
+                            .bounds = {0.2, 0.8}};
+}
+
+void test_level_round_trip() {
+  // screens 1 and 3 are empty
+  level_platform_t platforms[] = {
+      make_test_platform(LEVEL_STATIONARY, 0, 0.1),
+      make_test_platform(LEVEL_SLIPPERY, 0, 0.5),
+      make_test_platform(LEVEL_MOVING_X, 2, 0.3),
+      make_test_platform(LEVEL_DISAPPEARING, 4, 0.6),
+      make_test_platform(LEVEL_MOVING_Y, 4, 0.7),
+      make_test_platform(LEVEL_STATIONARY, 4, 0.8)};
+  assert(level_write(LEVEL_PATH, 5, platforms, 6));
+  level_t *level = level_open(LEVEL_PATH);
+  assert(level != NULL);
+  assert(level_screens(level) == 5);
+  size_t expected_counts[] = {2, 0, 1, 0, 3};
+  size_t next = 0;
+  for (size_t s = 0; s < 5; s++) {
+    size_t count;
+    const level_platform_t *screen = level_screen_platforms(level, s, &count);
+    assert(count == expected_counts[s]);
+    for (size_t i = 0; i < count; i++) {
+      const level_platform_t *expected = &platforms[next++];
+      assert(screen[i].type == expected->type);
+      assert(screen[i].screen == s);
+      assert(vec_equal(screen[i].bottom_left, expected->bottom_left));
+      assert(vec_equal(screen[i].top_right, expected->top_right));
+      assert(vec_equal(screen[i].velocity, expected->velocity));
+      assert(vec_equal(screen[i].bounds, expected->bounds));
+    }
+  }
+  level_close(level);
+  remove(LEVEL_PATH);
+}
+
+void test_level_empty() {
+  assert(level_write(LEVEL_PATH, 3, NULL, 0));
+  level_t *level = level_open(LEVEL_PATH);
+  assert(level != NULL);
+  assert(level_screens(level) == 3);
+  size_t count;
+  level_screen_platforms(level, 2, &count);
+  assert(count == 0);
+  level_close(level);
+  remove(LEVEL_PATH);
+}
+
+void test_level_invalid() {
+  assert(level_open("/tmp/test_level_missing.lvl") == NULL);
+  FILE *file = fopen(LEVEL_PATH, "wb");
+  fputs("not a level file, but long enough to have a header", file);
+  fclose(file);
+  assert(level_open(LEVEL_PATH) == NULL);
+
+  // a truncated level is rejected
+  level_platform_t platforms[] = {make_test_platform(LEVEL_STATIONARY, 0, 0),
+                                  make_test_platform(LEVEL_STATIONARY, 1, 0)};
+  assert(level_write(LEVEL_PATH, 2, platforms, 2));
+  file = fopen(LEVEL_PATH, "rb");
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fclose(file);
+  assert(truncate(LEVEL_PATH, size - 1) == 0);
+  assert(level_open(LEVEL_PATH) == NULL);
+  remove(LEVEL_PATH);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_level_round_trip)
+  DO_TEST(test_level_empty)
+  DO_TEST(test_level_invalid)
+
+  puts("level_test PASS");
+}
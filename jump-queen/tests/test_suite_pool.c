@@ -0,0 +1,76 @@
+#include "pool.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+void test_pool_alloc() {
+  const size_t OBJECTS = 100, SIZE = 24;
+  pool_t *pool = pool_init(SIZE, 16);
+  char *objects[OBJECTS];
+  for (size_t i = 0; i < OBJECTS; i++) {
+    objects[i] = pool_alloc(pool);
+    assert((uintptr_t)objects[i] % _Alignof(max_align_t) == 0);
+    memset(objects[i], i, SIZE);
+  }
+  assert(pool_live(pool) == OBJECTS);
+  assert(pool_capacity(pool) >= OBJECTS);
+  // objects never overlap
+  for (size_t i = 0; i < OBJECTS; i++) {
+    for (size_t j = 0; j < SIZE; j++) {
+      assert(objects[i][j] == (char)i);
+    }
+  }
+  for (size_t i = 0; i < OBJECTS; i++) {
+    pool_release(pool, objects[i]);
+  }
+  assert(pool_live(pool) == 0);
+  pool_free(pool);
+}
+
+void test_pool_reuse() {
+  pool_t *pool = pool_init(sizeof(double), 4);
+  void *first = pool_alloc(pool);
+  pool_release(pool, first);
+  assert(pool_alloc(pool) == first);
+  pool_release(pool, first);
+  pool_release(pool, NULL);
+  // churning through objects does not grow the pool
+  size_t capacity = pool_capacity(pool);
+  for (size_t i = 0; i < 1000; i++) {
+    void *a = pool_alloc(pool), *b = pool_alloc(pool);
+    pool_release(pool, a);
+    pool_release(pool, b);
+  }
+  assert(pool_capacity(pool) == capacity);
+  assert(pool_live(pool) == 0);
+  pool_free(pool);
+}
+
+void test_pool_tiny_objects() {
+  pool_t *pool = pool_init(1, 8);
+  char *a = pool_alloc(pool), *b = pool_alloc(pool);
+  assert(a != b);
+  *a = 'a';
+  *b = 'b';
+  assert(*a == 'a');
+  pool_release(pool, a);
+  pool_release(pool, b);
+  pool_free(pool);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_pool_alloc)
+  DO_TEST(test_pool_reuse)
+  DO_TEST(test_pool_tiny_objects)
+
+  puts("pool_test PASS");
+}
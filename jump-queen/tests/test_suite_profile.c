@@ -0,0 +1,108 @@
+#include "profile.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Reads back everything written to a temporary file */
+char *read_back(FILE *file) {
+  long size = ftell(file);
+  rewind(file);
+  char *text = malloc(size + 1);
+  assert(fread(text, 1, size, file) == (size_t)size);
+  text[size] = '\0';
+  return text;
+}
+
+/** Counts the times a string appears in some text */
+size_t count_occurrences(const char *text, const char *needle) {
+  size_t count = 0;
+  for (const char *found = strstr(text, needle); found != NULL;
+       found = strstr(found + 1, needle)) {
+    count++;
+  }
+  return count;
+}
+
+void test_profile_record() {
+  profile_reset();
+  profile_record(PROFILE_FORCES, profile_now() - 1000);
+  profile_record(PROFILE_FORCES, profile_now() - 500);
+  profile_stats_t stats = profile_get(PROFILE_FORCES);
+  assert(stats.count == 2);
+  assert(stats.ns >= 1500);
+  assert(profile_get(PROFILE_TICK).count == 0);
+  assert(strcmp(profile_phase_name(PROFILE_FORCES), "forces") == 0);
+  // the probes compile to nothing unless PROFILE is defined
+  PROFILE_BEGIN(PROFILE_RENDER);
+  PROFILE_END(PROFILE_RENDER);
+#ifdef PROFILE
+  assert(profile_get(PROFILE_RENDER).count == 1);
+#else
+  assert(profile_get(PROFILE_RENDER).count == 0);
+#endif
+  profile_reset();
+  assert(profile_get(PROFILE_FORCES).count == 0);
+  assert(profile_get(PROFILE_FORCES).ns == 0);
+}
+
+void test_profile_frames() {
+  FILE *file = tmpfile();
+  assert(file != NULL);
+  profile_reset();
+  profile_report_frames(file);
+  profile_record(PROFILE_TICK, profile_now());
+  profile_frame();
+  profile_frame();
+  profile_report_frames(NULL);
+  profile_frame();
+  assert(profile_get(PROFILE_FRAME).count == 3);
+  assert(profile_get(PROFILE_TICK).count == 1);
+  profile_report(file);
+  char *text = read_back(file);
+  // only the frames while reporting are printed, with the phases they ran
+  assert(strstr(text, "frame 0: tick 1x") != NULL);
+  assert(strstr(text, "frame 1: frame 1x") != NULL);
+  assert(strstr(text, "frame 2:") == NULL);
+  assert(strstr(text, "phase") != NULL);
+  free(text);
+  fclose(file);
+}
+
+void test_profile_trace() {
+  profile_reset();
+  // nothing is kept until the trace starts
+  profile_record(PROFILE_COLLISION, profile_now());
+  profile_trace_start();
+  uint64_t start = profile_now();
+  profile_record(PROFILE_BODY_TICK, start);
+  profile_record(PROFILE_BODY_TICK, start);
+  profile_record(PROFILE_TICK, start);
+  FILE *file = tmpfile();
+  assert(file != NULL);
+  assert(profile_trace_write(file));
+  char *text = read_back(file);
+  assert(strncmp(text, "{\"traceEvents\":[", 16) == 0);
+  assert(count_occurrences(text, "\"ph\":\"X\"") == 3);
+  assert(count_occurrences(text, "\"name\":\"body_tick\"") == 2);
+  assert(count_occurrences(text, "\"name\":\"collision\"") == 0);
+  free(text);
+  fclose(file);
+  profile_reset();
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_profile_record)
+  DO_TEST(test_profile_frames)
+  DO_TEST(test_profile_trace)
+
+  puts("profile_test PASS");
+}
@@ -0,0 +1,119 @@
+#include "random.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdbool.h>
+
+const size_t SAMPLES = 10000;
+
+void test_rng_reference() {
+  // the first outputs of the reference xoshiro256** from this state
+  rng_t rng = {.state = {1, 2, 3, 4}};
+  uint64_t expected[] = {11520, 0, 1509978240, 1215971899390074240};
+  for (size_t i = 0; i < 4; i++) {
+    assert(rng_next(&rng) == expected[i]);
+  }
+}
+
+void test_rng_seed() {
+  rng_t a, b, c;
+  rng_seed(&a, 42);
+  rng_seed(&b, 42);
+  rng_seed(&c, 43);
+  bool differs = false;
+  for (size_t i = 0; i < 100; i++) {
+    uint64_t next = rng_next(&a);
+    assert(next == rng_next(&b));
+    differs |= next != rng_next(&c);
+  }
+  assert(differs);
+  // the global generator repeats after reseeding too
+  r_seed(7);
+  double first = r_double(0, 1);
+  int second = r_int(0, 1000);
+  r_seed(7);
+  assert(r_double(0, 1) == first);
+  assert(r_int(0, 1000) == second);
+}
+
+void test_rng_ranges() {
+  rng_t rng;
+  rng_seed(&rng, 1);
+  bool seen[5] = {false};
+  int positive = 0;
+  for (size_t i = 0; i < SAMPLES; i++) {
+    int n = rng_int(&rng, -2, 2);
+    assert(-2 <= n && n <= 2);
+    seen[n + 2] = true;
+    double x = rng_double(&rng, 3, 5);
+    assert(3 <= x && x < 5);
+    int sign = rng_sign(&rng);
+    assert(sign == 1 || sign == -1);
+    positive += sign == 1;
+  }
+  for (size_t i = 0; i < 5; i++) {
+    assert(seen[i]);
+  }
+  assert(within(0.05 * SAMPLES, positive, 0.5 * SAMPLES));
+  // ranges that cover every int
+  assert(rng_int(&rng, 3, 3) == 3);
+  rng_int(&rng, -2147483647 - 1, 2147483647);
+}
+
+void test_rng_split() {
+  rng_t rng;
+  rng_seed(&rng, 5);
+  rng_t before = rng;
+  rng_t stream = rng_split(&rng);
+  // the stream continues where the generator was...
+  assert(rng_next(&stream) == rng_next(&before));
+  // ...and the generator jumped ahead
+  rng_t jumped;
+  rng_seed(&jumped, 5);
+  rng_jump(&jumped);
+  assert(rng_next(&rng) == rng_next(&jumped));
+  // later splits give different streams
+  bool overlaps = false;
+  rng_t other = rng_split(&rng);
+  for (size_t i = 0; i < 100; i++) {
+    overlaps |= rng_next(&other) == rng_next(&stream);
+  }
+  assert(!overlaps);
+}
+
+void test_rng_fill() {
+  rng_t a, b;
+  rng_seed(&a, 9);
+  rng_seed(&b, 9);
+  double values[100];
+  rng_fill_doubles(&a, values, 100, -1, 4);
+  for (size_t i = 0; i < 100; i++) {
+    assert(values[i] == rng_double(&b, -1, 4));
+  }
+  rgb_color_t colors[10];
+  rng_fill_colors(&a, colors, 10);
+  for (size_t i = 0; i < 10; i++) {
+    rgb_color_t color = rng_color(&b);
+    assert(colors[i].r == color.r && colors[i].g == color.g &&
+           colors[i].b == color.b);
+    assert(0 <= color.r && color.r <= 1);
+  }
+  assert(rng_next(&a) == rng_next(&b));
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_rng_reference)
+  DO_TEST(test_rng_seed)
+  DO_TEST(test_rng_ranges)
+  DO_TEST(test_rng_split)
+  DO_TEST(test_rng_fill)
+
+  puts("random_test PASS");
+}
@@ -0,0 +1,133 @@
+#include "raster.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const uint32_t BLACK = 0xff000000, RED = 0xffff0000, BLUE = 0xff0000ff;
+
+/** Counts the pixels of a framebuffer that have the given color */
+size_t count_color(raster_t *raster, uint32_t color) {
+  uint32_t *pixels = raster_pixels(raster);
+  size_t count = 0;
+  for (size_t i = 0; i < raster_width(raster) * raster_height(raster); i++) {
+    count += pixels[i] == color;
+  }
+  return count;
+}
+
+void test_raster_fill_span() {
+  uint32_t pixels[20];
+  // every length and alignment, without writing outside the span
+  for (size_t start = 0; start < 4; start++) {
+    for (size_t count = 0; start + count < 19; count++) {
+      raster_fill_span(pixels, 20, BLACK);
+      raster_fill_span(pixels + start, count, RED);
+      for (size_t i = 0; i < 20; i++) {
+        bool inside = start <= i && i < start + count;
+        assert(pixels[i] == (inside ? RED : BLACK));
+      }
+    }
+  }
+}
+
+void test_raster_rectangle() {
+  raster_t *raster = raster_init(10, 8);
+  raster_clear(raster, BLACK);
+  assert(count_color(raster, BLACK) == 80);
+  // covers the centers of columns 2..5 and rows 1..3
+  vector_t rect[] = {{2, 1}, {6, 1}, {6, 4}, {2, 4}};
+  raster_fill_polygon(raster, rect, 4, RED);
+  assert(count_color(raster, RED) == 12);
+  uint32_t *pixels = raster_pixels(raster);
+  for (size_t y = 0; y < 8; y++) {
+    for (size_t x = 0; x < 10; x++) {
+      bool inside = 2 <= x && x < 6 && 1 <= y && y < 4;
+      assert(pixels[y * 10 + x] == (inside ? RED : BLACK));
+    }
+  }
+  raster_free(raster);
+}
+
+void test_raster_shared_edge() {
+  // two triangles splitting a square fill each pixel exactly once
+  raster_t *raster = raster_init(20, 20);
+  raster_clear(raster, BLACK);
+  vector_t lower[] = {{1.3, 2.7}, {17.2, 2.7}, {17.2, 15.1}};
+  vector_t upper[] = {{1.3, 2.7}, {17.2, 15.1}, {1.3, 15.1}};
+  raster_fill_polygon(raster, lower, 3, RED);
+  size_t red = count_color(raster, RED);
+  raster_fill_polygon(raster, upper, 3, BLUE);
+  size_t blue = count_color(raster, BLUE);
+  // no pixel is filled by both, and together they cover the square:
+  // columns 1..16 and rows 3..14
+  assert(count_color(raster, RED) == red);
+  assert(red + blue == 16 * 12);
+  raster_free(raster);
+}
+
+void test_raster_area() {
+  // a large circle covers about as many pixels as its area
+  raster_t *raster = raster_init(200, 200);
+  raster_clear(raster, BLACK);
+  const size_t N = 64;
+  const double RADIUS = 80;
+  vector_t circle[N];
+  for (size_t i = 0; i < N; i++) {
+    double angle = 2 * M_PI * i / N;
+    circle[i] = (vector_t){100 + RADIUS * cos(angle),
+                           100 + RADIUS * sin(angle)};
+  }
+  raster_fill_polygon(raster, circle, N, RED);
+  double area = 0.5 * N * RADIUS * RADIUS * sin(2 * M_PI / N);
+  assert(fabs(count_color(raster, RED) - area) < 0.01 * area);
+  raster_free(raster);
+}
+
+void test_raster_clipping() {
+  raster_t *raster = raster_init(10, 10);
+  raster_clear(raster, BLACK);
+  vector_t huge[] = {{-100, -100}, {100, -100}, {100, 100}, {-100, 100}};
+  raster_fill_polygon(raster, huge, 4, RED);
+  assert(count_color(raster, RED) == 100);
+  raster_clear(raster, BLACK);
+  vector_t outside[] = {{20, 20}, {30, 20}, {30, 30}};
+  raster_fill_polygon(raster, outside, 3, RED);
+  assert(count_color(raster, RED) == 0);
+  raster_outline_rect(raster, -1, 2, 5, 4, BLUE);
+  // the left side is clipped: 4 + 4 on the top and bottom, 2 on the right
+  assert(count_color(raster, BLUE) == 10);
+  raster_free(raster);
+}
+
+void test_raster_read_rgb() {
+  raster_t *raster = raster_init(2, 1);
+  raster_pixels(raster)[0] = 0xff123456;
+  raster_pixels(raster)[1] = 0xffabcdef;
+  uint8_t rgb[6];
+  raster_read_rgb(raster, rgb);
+  uint8_t expected[] = {0x12, 0x34, 0x56, 0xab, 0xcd, 0xef};
+  for (size_t i = 0; i < 6; i++) {
+    assert(rgb[i] == expected[i]);
+  }
+  raster_free(raster);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_raster_fill_span)
+  DO_TEST(test_raster_rectangle)
+  DO_TEST(test_raster_shared_edge)
+  DO_TEST(test_raster_area)
+  DO_TEST(test_raster_clipping)
+  DO_TEST(test_raster_read_rgb)
+
+  puts("raster_test PASS");
+}
@@ -0,0 +1,91 @@
+#include "replay.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const char *REPLAY_PATH = "/tmp/test_replay.log";
+
+void test_replay_round_trip() {
+  replay_t *replay = replay_record(REPLAY_PATH, 0x123456789abcdefULL);
+  replay_write_tick(replay, 0);
+  replay_write_key(replay, (key_event_t){SPACE_BAR, KEY_PRESSED, 0});
+  replay_write_tick(replay, 1 / 60.0);
+  replay_write_tick(replay, 0.02);
+  replay_write_key(replay, (key_event_t){LEFT_ARROW, KEY_PRESSED, 0.5});
+  replay_write_key(replay, (key_event_t){SPACE_BAR, KEY_RELEASED, 0.25});
+  replay_write_tick(replay, 1e-9);
+  assert(replay_ticks(replay) == 4);
+  replay_close(replay);
+
+  replay = replay_play(REPLAY_PATH);
+  assert(replay != NULL);
+  assert(replay_seed(replay) == 0x123456789abcdefULL);
+  assert(replay_read_tick(replay) == 0);
+  key_event_t key = replay_read_key(replay);
+  assert(key.key == SPACE_BAR && key.type == KEY_PRESSED &&
+         key.held_time == 0);
+  assert(replay_read_tick(replay) == 1 / 60.0);
+  assert(replay_read_tick(replay) == 0.02);
+  assert(replay_next(replay) == REPLAY_KEY);
+  key = replay_read_key(replay);
+  assert(key.key == LEFT_ARROW && key.type == KEY_PRESSED &&
+         key.held_time == 0.5);
+  key = replay_read_key(replay);
+  assert(key.key == SPACE_BAR && key.type == KEY_RELEASED &&
+         key.held_time == 0.25);
+  assert(replay_next(replay) == REPLAY_TICK);
+  assert(replay_read_tick(replay) == 1e-9);
+  assert(replay_next(replay) == REPLAY_END);
+  assert(replay_ticks(replay) == 4);
+  replay_close(replay);
+  remove(REPLAY_PATH);
+}
+
+void test_replay_truncated() {
+  replay_t *replay = replay_record(REPLAY_PATH, 7);
+  replay_write_tick(replay, 0.5);
+  replay_write_tick(replay, 0.25);
+  replay_close(replay);
+  // cut the last record short, as if the recording program crashed
+  FILE *file = fopen(REPLAY_PATH, "rb");
+  char data[100];
+  size_t size = fread(data, 1, sizeof(data), file);
+  fclose(file);
+  file = fopen(REPLAY_PATH, "wb");
+  fwrite(data, 1, size - 1, file);
+  fclose(file);
+
+  replay = replay_play(REPLAY_PATH);
+  assert(replay != NULL);
+  assert(replay_seed(replay) == 7);
+  assert(replay_read_tick(replay) == 0.5);
+  assert(replay_next(replay) == REPLAY_END);
+  replay_close(replay);
+  remove(REPLAY_PATH);
+}
+
+void test_replay_invalid() {
+  assert(replay_play("/tmp/test_replay_missing.log") == NULL);
+  FILE *file = fopen(REPLAY_PATH, "wb");
+  fputs("not a replay log", file);
+  fclose(file);
+  assert(replay_play(REPLAY_PATH) == NULL);
+  remove(REPLAY_PATH);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_replay_round_trip)
+  DO_TEST(test_replay_truncated)
+  DO_TEST(test_replay_invalid)
+
+  puts("replay_test PASS");
+}
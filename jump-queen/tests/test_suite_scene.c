@@ -1,3 +1,4 @@
+#include "forces.h"
 #include "scene.h"
 #include "test_util.h"
 #include <assert.h>
@@ -228,6 +229,360 @@ void test_reaping() {
   scene_free(scene);
 }
 
+void count_contacts(bool last_tick_collision, body_t *body1, body_t *body2,
+                    vector_t axis, void *aux) {
+  (*(int *)aux)++;
+}
+
+void test_sleeping_islands() {
+  const double DT = 0.1, TIME_TO_SLEEP = 0.5;
+  scene_t *scene = scene_init();
+  scene_set_sleep(scene, 1e-3, TIME_TO_SLEEP);
+  // two touching boxes and one box on its own
+  body_t *left = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *right = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *alone = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(right, (vector_t){1.5, 0});
+  body_set_centroid(alone, (vector_t){10, 0});
+  scene_add_body(scene, left);
+  scene_add_body(scene, right);
+  scene_add_body(scene, alone);
+  int *contacts = malloc(sizeof(*contacts));
+  *contacts = 0;
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, left);
+  list_add(bodies, right);
+  create_collision(scene, bodies, count_contacts, contacts, free);
+
+  for (int i = 0; i < 10; i++) {
+    scene_tick(scene, DT);
+  }
+  assert(body_is_sleeping(left));
+  assert(body_is_sleeping(right));
+  assert(body_is_sleeping(alone));
+  // the collision between two sleeping bodies is no longer checked
+  int contacts_while_asleep = *contacts;
+  scene_tick(scene, DT);
+  assert(*contacts == contacts_while_asleep);
+
+  // waking one body of the island wakes the body it is touching as well
+  body_add_impulse(left, (vector_t){-1, 0});
+  assert(!body_is_sleeping(left));
+  scene_tick(scene, DT);
+  assert(!body_is_sleeping(right));
+  assert(body_is_sleeping(alone));
+  assert(vec_isclose(body_get_centroid(alone), (vector_t){10, 0}));
+  scene_free(scene);
+}
+
+// a body that has rested long enough keeps motion it was given this tick
+void test_sleep_keeps_new_motion() {
+  const double DT = 0.1, TIME_TO_SLEEP = 0.5;
+  scene_t *scene = scene_init();
+  scene_set_sleep(scene, 1e-3, TIME_TO_SLEEP);
+  body_t *pushed = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *hit = body_init(make_shape(), 2, (rgb_color_t){0, 0, 0});
+  body_set_centroid(hit, (vector_t){10, 0});
+  scene_add_body(scene, pushed);
+  scene_add_body(scene, hit);
+  for (int i = 0; i < 5; i++) {
+    scene_tick(scene, DT);
+  }
+  assert(!body_is_sleeping(pushed) && !body_is_sleeping(hit));
+  assert(body_get_rest_time(pushed) >= TIME_TO_SLEEP);
+  body_set_velocity(pushed, (vector_t){1, 0});
+  body_add_impulse(hit, (vector_t){0, 2});
+  scene_tick(scene, DT);
+  assert(!body_is_sleeping(pushed) && !body_is_sleeping(hit));
+  assert(vec_isclose(body_get_velocity(pushed), (vector_t){1, 0}));
+  assert(vec_isclose(body_get_velocity(hit), (vector_t){0, 1}));
+  scene_free(scene);
+}
+
+void test_sleepability() {
+  scene_t *scene = scene_init();
+  scene_set_sleep(scene, 1e-3, 0.1);
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_sleepability(body, false);
+  scene_add_body(scene, body);
+  for (int i = 0; i < 10; i++) {
+    scene_tick(scene, 0.1);
+  }
+  assert(!body_is_sleeping(body));
+  body_set_sleepability(body, true);
+  for (int i = 0; i < 10; i++) {
+    scene_tick(scene, 0.1);
+  }
+  assert(body_is_sleeping(body));
+  scene_set_sleep(scene, 0, 0);
+  assert(!body_is_sleeping(body));
+  scene_free(scene);
+}
+
+// A fast body crosses a thin wall in one tick unless it substeps
+void test_substepping() {
+  for (size_t max_substeps = 1; max_substeps <= 16; max_substeps += 15) {
+    scene_t *scene = scene_init();
+    scene_set_substepping(scene, max_substeps);
+    body_t *bullet = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(bullet, (vector_t){-15, 0});
+    body_set_velocity(bullet, (vector_t){100, 0});
+    scene_add_body(scene, bullet);
+    body_t *wall = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, wall);
+    list_t *bodies = list_init(2, NULL);
+    list_add(bodies, bullet);
+    list_add(bodies, wall);
+    create_physics_collision(scene, 1, bodies);
+    for (int i = 0; i < 3; i++) {
+      scene_tick(scene, 0.1);
+    }
+    if (max_substeps == 1) {
+      assert(body_get_velocity(bullet).x > 0);
+      assert(body_get_centroid(bullet).x > 1);
+    } else {
+      assert(vec_isclose(body_get_velocity(bullet), (vector_t){-100, 0}));
+      assert(body_get_centroid(bullet).x < -1);
+    }
+    assert(vec_isclose(body_get_centroid(wall), VEC_ZERO));
+    scene_free(scene);
+  }
+}
+
+// RK4 resamples a spring only if the integrator moves both of its bodies
+void test_rk4_substepped_spring() {
+  const double K = 2, DT = 0.1;
+  scene_t *scene = scene_init();
+  scene_set_integrator(scene, INTEGRATOR_RK4);
+  scene_set_substepping(scene, 16);
+  body_t *anchor = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_t *bullet = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(bullet, (vector_t){10, 0});
+  body_set_velocity(bullet, (vector_t){0, 100});
+  scene_add_body(scene, anchor);
+  scene_add_body(scene, bullet);
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, anchor);
+  list_add(bodies, bullet);
+  create_spring(scene, K, bodies);
+  scene_tick(scene, DT);
+  // the bullet is substepped with the spring force from the start of the tick
+  assert(vec_isclose(body_get_velocity(bullet), (vector_t){-K * 10 * DT, 100}));
+  scene_free(scene);
+}
+
+void test_handles() {
+  scene_t *scene = scene_init();
+  body_handle_t handles[4];
+  body_t *bodies[4];
+  for (size_t i = 0; i < 4; i++) {
+    bodies[i] = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    handles[i] = scene_add_body(scene, bodies[i]);
+    assert(body_handle_equal(body_get_handle(bodies[i]), handles[i]));
+  }
+  for (size_t i = 0; i < 4; i++) {
+    assert(scene_resolve(scene, handles[i]) == bodies[i]);
+  }
+  assert(!scene_handle_valid(scene, BODY_HANDLE_NULL));
+  scene_remove_handle(scene, handles[1]);
+  body_remove(bodies[2]);
+  assert(!scene_handle_valid(scene, handles[1]));
+  assert(!scene_handle_valid(scene, handles[2]));
+  scene_tick(scene, 1);
+  // removed bodies are compacted out, keeping the order of the others
+  assert(scene_bodies(scene) == 2);
+  assert(scene_get_body(scene, 0) == bodies[0]);
+  assert(scene_get_body(scene, 1) == bodies[3]);
+  // a reused slot does not revive old handles
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_handle_t handle = scene_add_body(scene, body);
+  assert(handle.index == handles[1].index || handle.index == handles[2].index);
+  assert(!scene_handle_valid(scene, handles[1]));
+  assert(!scene_handle_valid(scene, handles[2]));
+  assert(scene_resolve(scene, handle) == body);
+  assert(scene_resolve(scene, handles[3]) == bodies[3]);
+  scene_free(scene);
+}
+
+// body info for the save tests: an optional int
+bool save_int_info(void *info, FILE *file) {
+  int value = info == NULL ? -1 : *(int *)info;
+  return fwrite(&value, sizeof(int), 1, file) == 1;
+}
+
+bool load_int_info(FILE *file, void *context, void **info) {
+  int value;
+  if (fread(&value, sizeof(int), 1, file) != 1) {
+    return false;
+  }
+  *info = NULL;
+  if (value >= 0) {
+    *info = malloc(sizeof(int));
+    *(int *)*info = value;
+  }
+  return true;
+}
+
+const info_codec_t INT_INFO_CODEC = {save_int_info, load_int_info, free};
+
+void test_save_load() {
+  scene_t *scene = scene_init();
+  scene_set_sleep(scene, 0.1, 1);
+  body_handle_t handles[6];
+  body_t *bodies[6];
+  for (size_t i = 0; i < 6; i++) {
+    int *info = malloc(sizeof(int));
+    *info = i;
+    bodies[i] = body_init_with_info(make_shape(), i == 0 ? INFINITY : i + 1,
+                                    (rgb_color_t){i / 6.0, 0, 1}, info, free);
+    body_set_centroid(bodies[i], (vector_t){3 * i, i});
+    body_set_velocity(bodies[i], (vector_t){i, -1});
+    handles[i] = scene_add_body(scene, bodies[i]);
+  }
+  // leave a free slot behind so the slot map is not trivial
+  scene_remove_handle(scene, handles[5]);
+  scene_tick(scene, 0.01);
+  body_set_info(bodies[4], NULL, NULL);
+
+  list_t *pair = list_init(2, NULL);
+  list_add(pair, bodies[1]);
+  list_add(pair, bodies[2]);
+  create_spring(scene, 5, pair);
+  list_t *dragged = list_init(1, NULL);
+  list_add(dragged, bodies[3]);
+  create_drag(scene, 0.5, dragged);
+  for (size_t i = 1; i < 5; i++) {
+    list_t *colliding = list_init(2, NULL);
+    list_add(colliding, bodies[0]);
+    list_add(colliding, bodies[i]);
+    create_physics_collision(scene, 0.5, colliding);
+  }
+  spring_network_t *network = create_spring_network(scene, 4);
+  list_t *rope = list_init(2, NULL);
+  list_add(rope, bodies[3]);
+  list_add(rope, bodies[4]);
+  spring_network_add(network, 100, rope);
+  scene_tick(scene, 0.01);
+
+  FILE *file = tmpfile();
+  assert(file != NULL);
+  assert(scene_save(scene, file, &INT_INFO_CODEC));
+  rewind(file);
+  scene_t *loaded = scene_load(file, &INT_INFO_CODEC, NULL);
+  assert(loaded != NULL);
+  fclose(file);
+
+  assert(scene_bodies(loaded) == 5);
+  assert(!scene_handle_valid(loaded, handles[5]));
+  for (size_t i = 0; i < 5; i++) {
+    body_t *body = scene_resolve(loaded, handles[i]);
+    assert(body != NULL && body == scene_get_body(loaded, i));
+    assert(vec_equal(body_get_centroid(body), body_get_centroid(bodies[i])));
+    assert(body_get_mass(body) == body_get_mass(bodies[i]));
+    if (i == 4) {
+      assert(body_get_info(body) == NULL);
+    } else {
+      assert(*(int *)body_get_info(body) == (int)i);
+    }
+  }
+  // the restored forces evolve the scene exactly like the original
+  for (size_t tick = 0; tick < 100; tick++) {
+    scene_tick(scene, 0.01);
+    scene_tick(loaded, 0.01);
+  }
+  assert(scene_bodies(loaded) == scene_bodies(scene));
+  for (size_t i = 0; i < 5; i++) {
+    body_t *body = scene_resolve(loaded, handles[i]);
+    assert(vec_equal(body_get_centroid(body), body_get_centroid(bodies[i])));
+    assert(vec_equal(body_get_velocity(body), body_get_velocity(bodies[i])));
+  }
+  // new bodies reuse the same slots
+  body_handle_t handle =
+      scene_add_body(scene, body_init(make_shape(), 1, (rgb_color_t){0}));
+  body_handle_t loaded_handle =
+      scene_add_body(loaded, body_init(make_shape(), 1, (rgb_color_t){0}));
+  assert(body_handle_equal(handle, loaded_handle));
+  scene_free(scene);
+  scene_free(loaded);
+}
+
+void test_load_invalid() {
+  FILE *file = tmpfile();
+  assert(file != NULL);
+  fputs("not a scene", file);
+  rewind(file);
+  assert(scene_load(file, NULL, NULL) == NULL);
+  fclose(file);
+
+  // a truncated snapshot is rejected too
+  scene_t *scene = scene_init();
+  scene_add_body(scene, body_init(make_shape(), 1, (rgb_color_t){0}));
+  file = tmpfile();
+  assert(scene_save(scene, file, NULL));
+  long size = ftell(file);
+  scene_free(scene);
+  for (long length = 0; length < size; length++) {
+    FILE *truncated = tmpfile();
+    rewind(file);
+    for (long i = 0; i < length; i++) {
+      fputc(fgetc(file), truncated);
+    }
+    rewind(truncated);
+    assert(scene_load(truncated, NULL, NULL) == NULL);
+    fclose(truncated);
+  }
+  fclose(file);
+}
+
+// loads a copy of a scene file with the uint32_t at offset replaced by value
+scene_t *load_patched(FILE *file, long offset, uint32_t value) {
+  FILE *patched = tmpfile();
+  assert(patched != NULL);
+  rewind(file);
+  for (int c = fgetc(file); c != EOF; c = fgetc(file)) {
+    fputc(c, patched);
+  }
+  fseek(patched, offset, SEEK_SET);
+  fwrite(&value, sizeof(uint32_t), 1, patched);
+  rewind(patched);
+  scene_t *scene = scene_load(patched, NULL, NULL);
+  fclose(patched);
+  return scene;
+}
+
+void test_load_corrupt() {
+  // offsets into the file: the header is 64 bytes, then the 3 slots'
+  // generations, then the 2 free slots, then the one body
+  const long INTEGRATOR = 8, SLOT_COUNT = 12, FREE_SLOTS = 76;
+  const long BODY_VERTICES = 84 + 136;
+  body_handle_t handles[3];
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < 3; i++) {
+    handles[i] =
+        scene_add_body(scene, body_init(make_shape(), 1, (rgb_color_t){0}));
+  }
+  scene_remove_handle(scene, handles[1]);
+  scene_remove_handle(scene, handles[2]);
+  scene_tick(scene, 0.01);
+  FILE *file = tmpfile();
+  assert(file != NULL);
+  assert(scene_save(scene, file, NULL));
+  scene_free(scene);
+
+  scene = load_patched(file, INTEGRATOR, 0);
+  assert(scene != NULL);
+  scene_free(scene);
+  assert(load_patched(file, INTEGRATOR, 100) == NULL);
+  // counts far larger than the file fail instead of allocating for them
+  assert(load_patched(file, SLOT_COUNT, UINT32_MAX) == NULL);
+  assert(load_patched(file, BODY_VERTICES, UINT32_MAX) == NULL);
+  // free slots must be distinct slots that no body holds
+  assert(load_patched(file, FREE_SLOTS, 3) == NULL);
+  assert(load_patched(file, FREE_SLOTS, handles[0].index) == NULL);
+  assert(load_patched(file, FREE_SLOTS + 4, handles[1].index) == NULL);
+  fclose(file);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -242,6 +597,15 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_force_creator)
   DO_TEST(test_force_creator_aux)
   DO_TEST(test_reaping)
+  DO_TEST(test_sleeping_islands)
+  DO_TEST(test_sleep_keeps_new_motion)
+  DO_TEST(test_sleepability)
+  DO_TEST(test_substepping)
+  DO_TEST(test_rk4_substepped_spring)
+  DO_TEST(test_handles)
+  DO_TEST(test_save_load)
+  DO_TEST(test_load_invalid)
+  DO_TEST(test_load_corrupt)
 
   puts("scene_test PASS");
 }
@@ -119,6 +119,117 @@ void test_random_orbit() {
   scene_free(scene);
 }
 
+// A spring far too stiff for explicit integration at this dt
+// should stay bounded and settle onto its anchor in a spring network.
+void test_stiff_spring_network() {
+  const double M = 1, K = 1e6, DT = 0.01;
+  const int STEPS = 1000;
+  scene_t *scene = scene_init();
+  body_t *body = body_init(make_square(), M, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body, (vector_t){10, 0});
+  scene_add_body(scene, body);
+  body_t *anchor = body_init(make_square(), INFINITY, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, anchor);
+  spring_network_t *network = create_spring_network(scene, 1);
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, body);
+  list_add(bodies, anchor);
+  spring_network_add(network, K, bodies);
+  assert(spring_network_springs(network) == 1);
+  for (int i = 0; i < STEPS; i++) {
+    scene_tick(scene, DT);
+    assert(fabs(body_get_centroid(body).x) <= 10 + 1e-7);
+  }
+  assert(vec_within(1e-3, body_get_centroid(body), VEC_ZERO));
+  assert(vec_equal(body_get_centroid(anchor), VEC_ZERO));
+  scene_free(scene);
+}
+
+// With a small dt the implicit network should follow the analytic oscillation
+void test_spring_network_sinusoid() {
+  const double M = 10, K = 2, A = 3, DT = 1e-4;
+  const int STEPS = 100000;
+  scene_t *scene = scene_init();
+  body_t *body = body_init(make_square(), M, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body, (vector_t){A, 0});
+  scene_add_body(scene, body);
+  body_t *anchor = body_init(make_square(), INFINITY, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, anchor);
+  spring_network_t *network = create_spring_network(scene, 1);
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, body);
+  list_add(bodies, anchor);
+  spring_network_add(network, K, bodies);
+  for (int i = 0; i < STEPS; i++) {
+    assert(vec_within(1e-2, body_get_centroid(body),
+                      (vector_t){A * cos(sqrt(K / M) * i * DT), 0}));
+    scene_tick(scene, DT);
+  }
+  scene_free(scene);
+}
+
+double spring_energy(body_t *body, double k) {
+  vector_t v = body_get_velocity(body), x = body_get_centroid(body);
+  return 0.5 * body_get_mass(body) * vec_dot(v, v) + 0.5 * k * vec_dot(x, x);
+}
+
+// Large ticks on an undamped spring: the symplectic integrators keep the
+// energy bounded, RK4 follows the analytic solution closely.
+void test_integrators_spring_energy() {
+  const double M = 10, K = 2, A = 3, DT = 0.1;
+  const int STEPS = 10000;
+  integrator_t integrators[] = {INTEGRATOR_SEMI_IMPLICIT_EULER,
+                                INTEGRATOR_VELOCITY_VERLET, INTEGRATOR_RK4};
+  for (size_t i = 0; i < 3; i++) {
+    scene_t *scene = scene_init();
+    scene_set_integrator(scene, integrators[i]);
+    body_t *body = body_init(make_square(), M, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){A, 0});
+    scene_add_body(scene, body);
+    body_t *anchor = body_init(make_square(), INFINITY, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, anchor);
+    list_t *bodies = list_init(2, NULL);
+    list_add(bodies, body);
+    list_add(bodies, anchor);
+    create_spring(scene, K, bodies);
+    double initial_energy = spring_energy(body, K);
+    for (int j = 0; j < STEPS; j++) {
+      scene_tick(scene, DT);
+      assert(fabs(spring_energy(body, K) - initial_energy) <
+             0.05 * initial_energy);
+      if (integrators[i] == INTEGRATOR_RK4) {
+        assert(vec_within(
+            1e-2, body_get_centroid(body),
+            (vector_t){A * cos(sqrt(K / M) * (j + 1) * DT), 0}));
+      }
+    }
+    scene_free(scene);
+  }
+}
+
+// Velocity Verlet finishes each tick with the acceleration stored by the last
+// one, which must not outlive a velocity that was set or the body sleeping
+void test_verlet_stale_acceleration() {
+  const double DT = 0.1;
+  scene_t *scene = scene_init();
+  scene_set_integrator(scene, INTEGRATOR_VELOCITY_VERLET);
+  body_t *body = body_init(make_square(), 1, (rgb_color_t){0, 0, 0});
+  scene_add_body(scene, body);
+  body_add_force(body, (vector_t){0, -10});
+  scene_tick(scene, DT);
+  body_set_velocity(body, (vector_t){1, 0});
+  scene_tick(scene, DT);
+  assert(vec_isclose(body_get_velocity(body), (vector_t){1, 0}));
+
+  body_add_force(body, (vector_t){0, -10});
+  scene_tick(scene, DT);
+  body_sleep(body);
+  body_wake(body);
+  scene_tick(scene, DT);
+  assert(vec_isclose(body_get_velocity(body), VEC_ZERO));
+  scene_free(scene);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -131,6 +242,10 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_random_spring_sinusoid)
   DO_TEST(test_random_energy_conservation)
   DO_TEST(test_random_orbit);
+  DO_TEST(test_stiff_spring_network)
+  DO_TEST(test_spring_network_sinusoid)
+  DO_TEST(test_integrators_spring_energy)
+  DO_TEST(test_verlet_stale_acceleration)
 
   puts("student_test PASS");
 }
\ No newline at end of file
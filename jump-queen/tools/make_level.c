@@ -0,0 +1,108 @@
+#include "level.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Writes the Jump Queen level file, e.g. "bin/make_level levels/jumpqueen.lvl".
+// Platforms are laid out in design units: each screen is 2400 x 1800,
+// with y measured from the bottom of the screen the platform belongs to.
+
+const vector_t DESIGN_SCREEN = {2400, 1800};
+const size_t SCREEN_COUNT = 6;
+
+// the edges of the area between the walls and above the floor
+const double LEFT = 50, RIGHT = 2350, FLOOR = 150;
+
+typedef struct design_platform {
+  level_platform_type_t type;
+  size_t screen;
+  vector_t bottom_left;
+  vector_t top_right;
+  vector_t velocity;
+  vector_t bounds;
+} design_platform_t;
+
+const design_platform_t PLATFORMS[] = {
+    // screen 1
+    {LEVEL_STATIONARY, 0, {0, 0}, {2400, FLOOR}},
+    {LEVEL_STATIONARY, 0, {LEFT, FLOOR}, {650, 875}},
+    {LEVEL_STATIONARY, 0, {1750, FLOOR}, {RIGHT, 875}},
+    {LEVEL_STATIONARY, 0, {925, 1350}, {1475, 1600}},
+    // screen 2
+    {LEVEL_STATIONARY, 1, {1600, 160}, {1960, 320}},
+    {LEVEL_STATIONARY, 1, {2040, 640}, {RIGHT, 810}},
+    {LEVEL_MOVING_X, 1, {700, 640}, {1060, 810}, {240, 0}, {530, 1550}},
+    {LEVEL_STATIONARY, 1, {600, 1050}, {900, 1290}},
+    {LEVEL_STATIONARY, 1, {LEFT, 900}, {410, 1400}},
+    // screen 3
+    {LEVEL_STATIONARY, 2, {1040, 200}, {1280, 280}},
+    {LEVEL_STATIONARY, 2, {1600, 200}, {1880, 280}},
+    {LEVEL_STATIONARY, 2, {2120, 440}, {RIGHT, 530}},
+    {LEVEL_STATIONARY, 2, {960, 510}, {1640, 610}},
+    {LEVEL_MOVING_Y, 2, {1250, 1140}, {1690, 1250}, {0, -180}, {770, 1250}},
+    {LEVEL_MOVING_Y, 2, {700, 980}, {920, 1180}, {0, 180}, {980, 1550}},
+    {LEVEL_STATIONARY, 2, {LEFT, 1230}, {310, 1310}},
+    {LEVEL_STATIONARY, 2, {690, 1710}, {1030, 2000}},
+    {LEVEL_STATIONARY, 2, {2250, 1760}, {RIGHT, 1840}},
+    // screen 4
+    {LEVEL_STATIONARY, 3, {1400, 520}, {1600, 600}},
+    {LEVEL_STATIONARY, 3, {LEFT, 520}, {200, 600}},
+    {LEVEL_MOVING_X, 3, {2040, 920}, {2200, 1000}, {-180, 0}, {1650, 2240}},
+    {LEVEL_STATIONARY, 3, {1240, 1300}, {1400, 1360}},
+    {LEVEL_DISAPPEARING, 3, {930, 1380}, {1090, 1440}},
+    {LEVEL_SLIPPERY, 3, {610, 1460}, {770, 1520}},
+    {LEVEL_SLIPPERY, 3, {570, 1460}, {610, 2420}},
+    {LEVEL_SLIPPERY, 3, {1020, 1720}, {1860, 1840}},
+    {LEVEL_SLIPPERY, 3, {2200, 1775}, {RIGHT, 1880}},
+    // screen 5
+    {LEVEL_SLIPPERY, 4, {2150, 80}, {RIGHT, 200}},
+    {LEVEL_SLIPPERY, 4, {2200, 600}, {RIGHT, 750}},
+    {LEVEL_SLIPPERY, 4, {760, 460}, {1180, 590}},
+    {LEVEL_SLIPPERY, 4, {200, 300}, {360, 360}},
+    {LEVEL_SLIPPERY, 4, {830, 960}, {1060, 1090}},
+    {LEVEL_SLIPPERY, 4, {1870, 1230}, {2000, 1360}},
+    {LEVEL_SLIPPERY, 4, {1400, 1360}, {1630, 1490}},
+    // screen 6 is empty: reaching its top wins the game
+};
+
+/** Converts a point on a screen from design units to window units */
+vector_t to_window(vector_t point, size_t screen) {
+  return (vector_t){point.x / DESIGN_SCREEN.x,
+                    point.y / DESIGN_SCREEN.y + screen};
+}
+
+level_platform_t to_level(const design_platform_t *design) {
+  level_platform_t platform = {
+      .type = design->type,
+      .screen = design->screen,
+      .bottom_left = to_window(design->bottom_left, design->screen),
+      .top_right = to_window(design->top_right, design->screen),
+      .velocity = to_window(design->velocity, 0)};
+  // bounds are along the axis the platform moves on
+  if (design->type == LEVEL_MOVING_X) {
+    platform.bounds = vec_multiply(1 / DESIGN_SCREEN.x, design->bounds);
+  } else if (design->type == LEVEL_MOVING_Y) {
+    platform.bounds =
+        vec_add(vec_multiply(1 / DESIGN_SCREEN.y, design->bounds),
+                (vector_t){design->screen, design->screen});
+  }
+  return platform;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s LEVEL_FILE\n", argv[0]);
+    return 1;
+  }
+  size_t count = sizeof(PLATFORMS) / sizeof(PLATFORMS[0]);
+  level_platform_t *platforms = malloc(count * sizeof(level_platform_t));
+  for (size_t i = 0; i < count; i++) {
+    platforms[i] = to_level(&PLATFORMS[i]);
+  }
+  bool written = level_write(argv[1], SCREEN_COUNT, platforms, count);
+  free(platforms);
+  if (!written) {
+    fprintf(stderr, "could not write %s\n", argv[1]);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+"""Records benchmark and demo timings per commit and compares two records.
+
+  perf_gate.py record [--repeat N] [--bench BIN]... [--demo BIN --replay LOG]
+  perf_gate.py compare [--threshold T] [--alpha A] [--track GLOB]... BASE NEW
+
+`record` runs every benchmark (e.g. bin/bench_core, which prints one line of
+JSON per benchmark; see bench_util.h) and demo `--repeat` times, and saves
+every run's samples to perf/<commit>.json, or perf/<commit>-dirty.json if
+the tree has uncommitted changes. A demo is played back from a replay log (see
+replay.h) with the software renderer. Its per-frame phase times are only
+reported by -DPROFILE builds; otherwise only the replay's time per tick is
+recorded.
+
+`compare` takes two commits (anything `git rev-parse` accepts) or record
+files. Each metric is summarized by the median of every run, and the runs
+are compared with a one-sided Mann-Whitney U test of whether NEW's medians
+are larger than BASE's. Samples within a run are not independent (they
+share a process, its memory layout and whatever else the machine was
+doing), so only whole runs count. A metric regresses if the median of its
+run medians grew by more than the threshold and the test is significant.
+The exit status is 1 if any tracked metric regressed. With 5 runs each,
+the smallest possible p-value is 1/252, so fewer runs cannot show
+significance at the default level.
+
+Only the standard library is used, so this runs anywhere python3 does.
+Timings from different machines or builds are not comparable.
+"""
+
+import argparse
+import collections
+import datetime
+import fnmatch
+import json
+import math
+import os
+import platform
+import re
+import subprocess
+import sys
+
+RESULTS_DIR = "perf"
+BUILD_PATHS = ["bin", "out", ".debug"]
+FRAME_LINE = re.compile(r"^frame (\d+):(.*)$")
+FRAME_PHASE = re.compile(r"(\w+) (\d+)x ([\d.]+) us")
+REPLAY_LINE = re.compile(r"^Replayed (\d+) ticks in ([\d.]+) s$")
+# The first frame also times loading the demo
+SKIPPED_FRAMES = 1
+# Up to this many samples in all, with no ties, U's p-value is exact
+EXACT_SAMPLES = 40
+
+
+def git(*args):
+    return subprocess.run(["git", *args], check=True, capture_output=True,
+                          text=True).stdout.strip()
+
+
+def head_key():
+    """The results key for the checked out tree."""
+    commit = git("rev-parse", "HEAD")
+    # build products are not changes
+    dirty = git("status", "--porcelain", "--untracked-files=no", "--", ".",
+                *[":(exclude)" + path for path in BUILD_PATHS]) != ""
+    return commit + "-dirty" if dirty else commit
+
+
+def results_path(key):
+    return os.path.join(RESULTS_DIR, key + ".json")
+
+
+def add_samples(metrics, name, run, samples):
+    runs = metrics.setdefault(name, {"unit": "ns", "runs": []})["runs"]
+    while len(runs) <= run:
+        runs.append([])
+    runs[run].extend(samples)
+
+
+def run_bench(binary, run, metrics):
+    """Runs a benchmark, keeping the samples of every JSON line it prints."""
+    output = subprocess.run([binary], check=True, capture_output=True,
+                            text=True).stdout
+    for line in output.splitlines():
+        if not line.startswith("{"):
+            continue
+        result = json.loads(line)
+        add_samples(metrics, result["name"], run, result["samples"])
+
+
+def run_demo(binary, replay, run, metrics):
+    """Plays a replay log back in a demo, keeping its frame and tick times."""
+    demo = os.path.basename(binary)
+    environment = dict(os.environ, REPLAY=replay, RENDERER="software",
+                       PROFILE_REPORT="1")
+    for variable in ("REPLAY_RECORD", "CAPTURE", "PROFILE_TRACE"):
+        environment.pop(variable, None)
+    output = subprocess.run([binary], check=True, capture_output=True,
+                            text=True, env=environment).stdout
+    replayed = False
+    for line in output.splitlines():
+        frame = FRAME_LINE.match(line)
+        if frame is not None and int(frame.group(1)) >= SKIPPED_FRAMES:
+            for phase, _, us in FRAME_PHASE.findall(frame.group(2)):
+                add_samples(metrics, "demo/%s/%s" % (demo, phase), run,
+                            [float(us) * 1e3])
+        replay_line = REPLAY_LINE.match(line)
+        if replay_line is not None and int(replay_line.group(1)) > 0:
+            ticks, seconds = replay_line.groups()
+            add_samples(metrics, "demo/%s/replay_tick" % demo, run,
+                        [float(seconds) * 1e9 / int(ticks)])
+            replayed = True
+    if not replayed:
+        sys.exit("%s did not report its replay time" % binary)
+
+
+def record(args):
+    if not args.bench and not args.demo:
+        sys.exit("nothing to record: pass --bench or --demo")
+    if args.demo and args.replay is None:
+        sys.exit("--demo needs a --replay log to play back")
+    metrics = {}
+    for run in range(args.repeat):
+        print("run %d of %d" % (run + 1, args.repeat), file=sys.stderr)
+        for binary in args.bench:
+            run_bench(binary, run, metrics)
+        for binary in args.demo:
+            run_demo(binary, args.replay, run, metrics)
+    key = head_key()
+    results = {
+        "commit": key,
+        "date": datetime.datetime.now().isoformat(timespec="seconds"),
+        "host": platform.node(),
+        "repeat": args.repeat,
+        "benches": args.bench,
+        "demos": args.demo,
+        "metrics": metrics,
+    }
+    os.makedirs(RESULTS_DIR, exist_ok=True)
+    path = results_path(key)
+    with open(path, "w") as file:
+        json.dump(results, file, indent=1)
+    print("recorded %d metrics in %s" % (len(metrics), path))
+
+
+def load(name):
+    """Loads a record by file name or by commit."""
+    if os.path.isfile(name):
+        path = name
+    else:
+        try:
+            commit = git("rev-parse", "--verify", name + "^{commit}")
+        except subprocess.CalledProcessError:
+            sys.exit("%s is neither a record nor a commit" % name)
+        path = results_path(commit)
+        # HEAD with uncommitted changes means what is checked out
+        dirty_key = head_key()
+        if dirty_key == commit + "-dirty" and os.path.isfile(
+                results_path(dirty_key)):
+            path = results_path(dirty_key)
+        if not os.path.isfile(path):
+            sys.exit("no record for %s; run 'make perf-record' on it" % name)
+    with open(path) as file:
+        return json.load(file)
+
+
+def median(samples):
+    ordered = sorted(samples)
+    middle = len(ordered) // 2
+    if len(ordered) % 2 == 1:
+        return ordered[middle]
+    return (ordered[middle - 1] + ordered[middle]) / 2
+
+
+def run_medians(metric):
+    return [median(samples) for samples in metric["runs"] if samples]
+
+
+def ranks(values):
+    """Ranks values from 1, giving tied values the mean of their ranks."""
+    order = sorted(range(len(values)), key=lambda i: values[i])
+    result = [0.0] * len(values)
+    start = 0
+    while start < len(order):
+        end = start
+        while (end + 1 < len(order) and
+               values[order[end + 1]] == values[order[start]]):
+            end += 1
+        for i in range(start, end + 1):
+            result[order[i]] = (start + end) / 2 + 1
+        start = end + 1
+    return result
+
+
+def exact_u_tail(u, n1, n2):
+    """P(U >= u) when there are no ties, counting orderings of the samples."""
+    # counts[n][k] is the number of orderings of n samples of the first group
+    # and m of the second in which U = k, for m = 0, 1, ..., n2 in turn
+    counts = [[1] + [0] * (n1 * n2) for _ in range(n1 + 1)]
+    for m in range(1, n2 + 1):
+        next_counts = [[0] * (n1 * n2 + 1) for _ in range(n1 + 1)]
+        next_counts[0][0] = 1
+        for n in range(1, n1 + 1):
+            for k in range(n * m + 1):
+                # the largest sample is either one of the n or one of the m
+                ways = counts[n][k]
+                if k >= m:
+                    ways += next_counts[n - 1][k - m]
+                next_counts[n][k] = ways
+        counts = next_counts
+    total = math.comb(n1 + n2, n1)
+    return sum(counts[n1][math.ceil(u):]) / total
+
+
+def mann_whitney_greater(new, base):
+    """The one-sided p-value of the samples in new being larger than base's."""
+    n1, n2 = len(new), len(base)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    combined = list(new) + list(base)
+    rank = ranks(combined)
+    u = sum(rank[:n1]) - n1 * (n1 + 1) / 2
+    tied = len(set(combined)) < len(combined)
+    if n1 + n2 <= EXACT_SAMPLES and not tied:
+        return exact_u_tail(u, n1, n2)
+    # normal approximation, with a continuity correction and the variance
+    # lowered for ties
+    n = n1 + n2
+    tie_sum = sum(t ** 3 - t for t in collections.Counter(combined).values())
+    variance = n1 * n2 / 12 * ((n + 1) - tie_sum / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    z = (u - n1 * n2 / 2 - 0.5) / math.sqrt(variance)
+    return 0.5 * math.erfc(z / math.sqrt(2))
+
+
+def compare(args):
+    base, new = load(args.base), load(args.new)
+    if base.get("host") != new.get("host"):
+        print("warning: the records come from different hosts (%s and %s)" %
+              (base.get("host"), new.get("host")), file=sys.stderr)
+    print("%s -> %s" % (base["commit"][:12], new["commit"][:12]))
+    print("%-40s %12s %12s %8s %9s  %s" %
+          ("metric", "base ns", "new ns", "change", "p", ""))
+    regressions = []
+    for name in sorted(set(base["metrics"]) | set(new["metrics"])):
+        if name not in base["metrics"] or name not in new["metrics"]:
+            where = "base" if name in base["metrics"] else "new"
+            print("%-40s only measured in %s" % (name, where))
+            continue
+        before = run_medians(base["metrics"][name])
+        after = run_medians(new["metrics"][name])
+        change = median(after) / median(before) - 1 if median(before) else 0
+        slower = mann_whitney_greater(after, before)
+        faster = mann_whitney_greater(before, after)
+        tracked = not args.track or any(
+            fnmatch.fnmatchcase(name, pattern) for pattern in args.track)
+        verdict = ""
+        if change > args.threshold and slower < args.alpha:
+            verdict = "REGRESSED" if tracked else "slower (untracked)"
+            if tracked:
+                regressions.append(name)
+        elif change < -args.threshold and faster < args.alpha:
+            verdict = "faster"
+        print("%-40s %12.1f %12.1f %+7.1f%% %9.2g  %s" %
+              (name, median(before), median(after), change * 100,
+               min(slower, faster), verdict))
+    if regressions:
+        print("%d metric(s) regressed by more than %.0f%% (p < %g): %s" %
+              (len(regressions), args.threshold * 100, args.alpha,
+               ", ".join(regressions)))
+        return 1
+    print("no tracked metric regressed by more than %.0f%%" %
+          (args.threshold * 100))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+    recorder = commands.add_parser("record", help="record this commit")
+    recorder.add_argument("--repeat", type=int, default=5,
+                          help="times to run everything (default 5)")
+    recorder.add_argument("--bench", action="append", default=[],
+                          help="a benchmark executable to run")
+    recorder.add_argument("--demo", action="append", default=[],
+                          help="a demo executable to play the replay in")
+    recorder.add_argument("--replay", help="the replay log for the demos")
+    comparer = commands.add_parser("compare", help="compare two records")
+    comparer.add_argument("base", help="the commit or record to compare to")
+    comparer.add_argument("new", help="the commit or record being checked")
+    comparer.add_argument("--threshold", type=float, default=0.1,
+                          help="the largest allowed slowdown of a median "
+                          "(default 0.1, i.e. 10%%)")
+    comparer.add_argument("--alpha", type=float, default=0.05,
+                          help="the significance level (default 0.05)")
+    comparer.add_argument("--track", action="append", default=[],
+                          help="a glob of metrics that fail the comparison "
+                          "(default: all of them)")
+    args = parser.parse_args()
+    if args.command == "record":
+        record(args)
+        return 0
+    return compare(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())